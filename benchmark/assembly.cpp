@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <tomos/tomos.hpp>
+
+#include "disk.hpp"
+
+const std::size_t REPETITIONS = 20;
+
+double
+measure(tomos::Engine& engine, tomos::Strategy strategy, const std::vector<float>& conductivity) {
+    engine.strategy(strategy);
+    engine.stiffness(conductivity);     // builds the plan, not timed
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < REPETITIONS; i++) { engine.assemble(conductivity); }
+    engine.finish();
+    auto stop = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    return elapsed.count() / static_cast<double>(REPETITIONS);
+}
+
+int
+main(int, char**) {
+    try {
+        gmsh::initialize();
+        gmsh::option::setNumber("General.Terminal", 0);
+
+        std::cout   << std::setw(10) << "elements"
+                    << std::setw(12) << "nonzeros"
+                    << std::setw(12) << "color ms"
+                    << std::setw(12) << "atomic ms"
+                    << std::setw(12) << "reduce ms"
+                    << std::setw(12) << "tiled ms"
+                    << std::endl;
+
+        for (double lc : {1e-2, 5e-3, 2.5e-3, 1.25e-3, 6.25e-4}) {
+            tomos::mesh::Mesh mesh = benchmark::disk(lc);
+            tomos::Engine engine(mesh);
+
+            std::vector<float> conductivity(mesh.elements.size(), 1.0f);
+            double color    = measure(engine, tomos::Strategy::COLOR, conductivity);
+            double atomic   = measure(engine, tomos::Strategy::ATOMIC, conductivity);
+            double reduce   = measure(engine, tomos::Strategy::REDUCE, conductivity);
+            double tiled    = measure(engine, tomos::Strategy::TILED, conductivity);
+
+            std::cout   << std::fixed << std::setprecision(3)
+                        << std::setw(10) << mesh.elements.size()
+                        << std::setw(12) << engine.plan().nonzeros
+                        << std::setw(12) << color
+                        << std::setw(12) << atomic
+                        << std::setw(12) << reduce
+                        << std::setw(12) << tiled
+                        << std::endl;
+        }
+        gmsh::finalize();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,71 @@
+#ifndef TOMOS_BENCHMARK_DISK_HPP__
+#define TOMOS_BENCHMARK_DISK_HPP__
+
+#include <gmsh.h>
+
+#include <cmath>
+#include <map>
+#include <numbers>
+#include <tomos/tomos-mesh.hpp>
+
+namespace benchmark {
+    const double RADIUS             = 1e-1;
+    const std::size_t ELECTRODES    = 16;
+
+    // triangulated disk with characteristic length lc, gmsh must be initialized
+    inline tomos::mesh::Mesh
+    disk(double lc) {
+        gmsh::clear();
+        gmsh::model::add("disk");
+
+        for (std::size_t electrode = 0; electrode < ELECTRODES; electrode++) {
+            double step     = static_cast<double>(electrode) / static_cast<double>(ELECTRODES);
+            double angle    = 2.0 * std::numbers::pi * step;
+
+            double x = RADIUS * std::cos(angle);
+            double y = RADIUS * std::sin(angle);
+
+            gmsh::model::geo::addPoint(x, y, 0.0, lc, electrode);
+        }
+        std::vector<int> loop = {};
+        for (std::size_t electrode = 0; electrode < ELECTRODES; electrode++) {
+            loop.push_back(
+                    gmsh::model::geo::addLine(electrode, (electrode + 1) % ELECTRODES, electrode)
+                    );
+        }
+        gmsh::model::geo::addCurveLoop(loop, 1);
+        gmsh::model::geo::addPlaneSurface({1}, 1);
+        gmsh::model::geo::synchronize();
+        gmsh::model::mesh::generate(2);
+
+        std::vector<std::size_t> tags;
+        std::vector<double> coordinates, parameters;
+        gmsh::model::mesh::getNodes(tags, coordinates, parameters);
+
+        tomos::mesh::Mesh mesh;
+        std::map<std::size_t, tomos::mesh::node::Number> numbers;
+        for (std::size_t i = 0; i < tags.size(); i++) {
+            numbers[tags[i]] = static_cast<tomos::mesh::node::Number>(i);
+            mesh.nodes.push_back({{
+                  static_cast<float>(coordinates[3 * i + 0])
+                , static_cast<float>(coordinates[3 * i + 1])
+                , static_cast<float>(coordinates[3 * i + 2])
+            }});
+        }
+
+        const int TRIANGLE = 2;
+        std::vector<std::size_t> elements, nodes;
+        gmsh::model::mesh::getElementsByType(TRIANGLE, elements, nodes);
+        for (std::size_t i = 0; i < elements.size(); i++) {
+            tomos::mesh::node::Numbers ns = {
+                  numbers.at(nodes[3 * i + 0])
+                , numbers.at(nodes[3 * i + 1])
+                , numbers.at(nodes[3 * i + 2])
+            };
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, ns});
+        }
+        return mesh;
+    }
+} // namespace benchmark
+
+#endif // TOMOS_BENCHMARK_DISK_HPP__
@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <tomos/tomos.hpp>
+
+#include "disk.hpp"
+
+const std::size_t REPETITIONS = 20;
+
+double
+measure(tomos::Native& native, tomos::Native::Strategy strategy, const std::vector<float>& conductivity) {
+    native.strategy(strategy);
+    native.stiffness(conductivity);     // builds the plan, not timed
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < REPETITIONS; i++) { native.stiffness(conductivity); }
+    auto stop = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    return elapsed.count() / static_cast<double>(REPETITIONS);
+}
+
+// host assembly scaling with the thread count, colored against partitioned
+int
+main(int, char**) {
+    try {
+        gmsh::initialize();
+        gmsh::option::setNumber("General.Terminal", 0);
+
+        tomos::mesh::Mesh mesh  = benchmark::disk(6.25e-4);
+        auto topology           = std::make_shared<tomos::Topology>(mesh);
+        std::vector<float> conductivity(mesh.elements.size(), 1.0f);
+
+        std::cout   << std::setw(10) << "elements"
+                    << std::setw(10) << "threads"
+                    << std::setw(12) << "color ms"
+                    << std::setw(14) << "partition ms"
+                    << std::setw(10) << "speedup"
+                    << std::endl;
+
+        double serial = 0.0;
+        for (std::size_t threads = 1; threads <= tomos::parallel::concurrency(); threads *= 2) {
+            tomos::Native native(topology, threads);
+
+            double color        = measure(native, tomos::Native::Strategy::COLOR, conductivity);
+            double partition    = measure(native, tomos::Native::Strategy::PARTITION, conductivity);
+            if (threads == 1) { serial = partition; }
+
+            std::cout   << std::fixed << std::setprecision(3)
+                        << std::setw(10) << mesh.elements.size()
+                        << std::setw(10) << threads
+                        << std::setw(12) << color
+                        << std::setw(14) << partition
+                        << std::setw(10) << serial / partition
+                        << std::endl;
+        }
+        gmsh::finalize();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <tomos/tomos.hpp>
+
+#include "disk.hpp"
+
+const std::size_t REPETITIONS = 20;
+
+template <typename F>
+double
+measure(F&& f) {
+    f();    // builds plans and warms caches, not timed
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < REPETITIONS; i++) { f(); }
+    auto stop = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::milli> elapsed = stop - start;
+    return elapsed.count() / static_cast<double>(REPETITIONS);
+}
+
+int
+main(int, char**) {
+    try {
+        gmsh::initialize();
+        gmsh::option::setNumber("General.Terminal", 0);
+
+        const std::vector<std::pair<std::string, tomos::reorder::Options>> orderings = {
+              {"none",              {tomos::reorder::Nodes::NONE,   tomos::reorder::Elements::NONE}}
+            , {"rcm+hilbert",       {tomos::reorder::Nodes::RCM,    tomos::reorder::Elements::HILBERT}}
+            , {"rcm+morton",        {tomos::reorder::Nodes::RCM,    tomos::reorder::Elements::MORTON}}
+            , {"nested+hilbert",    {tomos::reorder::Nodes::NESTED, tomos::reorder::Elements::HILBERT}}
+            , {"rcm+partition",     {tomos::reorder::Nodes::RCM,    tomos::reorder::Elements::PARTITION, 64}}
+        };
+
+        std::cout   << std::setw(10) << "elements"
+                    << std::setw(16) << "ordering"
+                    << std::setw(12) << "bandwidth"
+                    << std::setw(12) << "reorder ms"
+                    << std::setw(12) << "engine ms"
+                    << std::setw(12) << "native ms"
+                    << std::endl;
+
+        for (double lc : {2.5e-3, 1.25e-3, 6.25e-4}) {
+            tomos::mesh::Mesh mesh = benchmark::disk(lc);
+
+            for (const auto& [name, options] : orderings) {
+                auto start = std::chrono::steady_clock::now();
+                tomos::reorder::Reordered reordered = tomos::reorder::build(mesh, options);
+                auto stop = std::chrono::steady_clock::now();
+                std::chrono::duration<double, std::milli> elapsed = stop - start;
+
+                std::vector<float> conductivity(mesh.elements.size(), 1.0f);
+                std::vector<float> permuted = tomos::reorder::permute<float>(reordered.elements, conductivity);
+
+                tomos::Engine engine(reordered.mesh);
+                tomos::Native native(reordered.mesh);
+
+                double device = measure([&]() { engine.assemble(permuted); engine.finish(); });
+                double host   = measure([&]() { native.stiffness(permuted); });
+
+                std::cout   << std::fixed << std::setprecision(3)
+                            << std::setw(10) << mesh.elements.size()
+                            << std::setw(16) << name
+                            << std::setw(12) << tomos::reorder::bandwidth(reordered.mesh)
+                            << std::setw(12) << elapsed.count()
+                            << std::setw(12) << device
+                            << std::setw(12) << host
+                            << std::endl;
+            }
+        }
+        gmsh::finalize();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    exit(EXIT_SUCCESS);
+}
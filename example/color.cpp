@@ -10,7 +10,7 @@ main(int argc, char** argv) {
         if (argc != 2) { throw std::invalid_argument("invalid number of arguments"); }
         tomos::mesh::Mesh mesh = tomos::mesh::decode(std::filesystem::path{argv[1]});
 
-        tomos::Engine engine("./shaders/tomos.kernel", mesh);
+        tomos::Engine engine(mesh);
         std::vector<float> vs = engine.color();
         for (auto v : vs) { std::cout << v << " "; }
     } catch (const std::exception& e) {
@@ -61,7 +61,7 @@ main(int, char**) {
             default: continue;
         }
     }
-    tomos::Engine engine("./shaders/tomos.kernel", forward);
+    tomos::Engine engine(forward);
     std::vector<float> vs = engine.color();
 
     return 0;
@@ -12,9 +12,9 @@ main(int argc, char** argv) {
 
         tomos::metis::Dual dual(mesh, tomos::metis::Common::EDGE);
 
-        for (const auto& [key, vs] : dual.adjacency()) {
+        for (std::size_t key = 0; key < dual.size(); key++) {
             std::cout << key << " : ";
-            for (const auto& v : vs) {
+            for (const auto& v : dual.neighbours(key)) {
                 std::cout << v << " ";
             }
             std::cout << std::endl;
@@ -33,9 +33,9 @@ main(int argc, char** argv) {
         std::cout << std::endl;
 
         tomos::metis::Nodal nodal(mesh);
-        for (const auto& [key, vs] : nodal.adjacency()) {
+        for (std::size_t key = 0; key < nodal.size(); key++) {
             std::cout << key << " : ";
-            for (const auto& v : vs) {
+            for (const auto& v : nodal.neighbours(key)) {
                 std::cout << v << " ";
             }
             std::cout << std::endl;
@@ -16,16 +16,11 @@ main(int argc, char** argv) {
         tomos::metis::Dual dual(mesh, tomos::metis::Common::EDGE);
         tomos::metis::Partitions ps = dual.partition(optimal);
 
-        for (const auto& [key, indices] : ps) { 
-            using tomos::mesh::node::Number;
-            using tomos::partition::Index;
-
-            std::set<Number> nodes;
-            for (const Index& index : indices) {
-                const tomos::mesh::Element& element = mesh.elements[index];
-                for (const Number& node : element.nodes) { nodes.insert(node); }
-            }
-            std::cout << key << " : " << nodes.size() << " nodes\n";
+        tomos::partition::Statistics statistics = tomos::partition::statistics(mesh, ps);
+        std::size_t p = 0;
+        for (const auto& [key, _] : ps) {
+            std::cout << key << " : " << statistics.nodes[p] << " nodes, " << statistics.halo[p] << " halo\n";
+            p++;
         }
         std::cout << std::flush;
     } catch (const std::exception& e) {
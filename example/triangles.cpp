@@ -11,11 +11,13 @@ main(int argc, char** argv) {
         if (argc != 2) { throw std::invalid_argument("invalid number of arguments"); }
         tomos::mesh::Mesh mesh = tomos::mesh::decode(std::filesystem::path{argv[1]});
 
-        tomos::Engine engine("./shaders/tomos.kernel", mesh);
+        tomos::Engine engine(mesh);
 
         std::vector<float> xs               = engine.area();
         std::vector<tomos::mesh::Node> ns   = engine.normal();
         std::vector<tomos::mesh::Node> cs   = engine.centroid();
+
+        tomos::Geometry geometry            = engine.geometry(true);
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         exit(EXIT_FAILURE);
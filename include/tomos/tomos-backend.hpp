@@ -0,0 +1,32 @@
+#ifndef TOMOS_BACKEND_HPP__
+#define TOMOS_BACKEND_HPP__
+
+#include <span>
+#include <tomos/tomos-mesh.hpp>
+#include <vector>
+
+namespace tomos {
+    // operations every numerical backend provides over a fixed mesh, the
+    // stiffness values follow the sorted CSR layout of sparse::pattern
+    class Backend {
+        public:
+            virtual ~Backend() = default;
+
+            virtual std::vector<float>
+            area() = 0;
+
+            virtual std::vector<tomos::mesh::Node>
+            centroid() = 0;
+
+            virtual std::vector<tomos::mesh::Node>
+            normal() = 0;
+
+            virtual std::vector<float>
+            color() = 0;
+
+            virtual std::vector<float>
+            stiffness(std::span<const float> conductivity) = 0;
+    };
+} // namespace tomos
+
+#endif // TOMOS_BACKEND_HPP__
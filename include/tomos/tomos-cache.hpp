@@ -0,0 +1,38 @@
+#ifndef TOMOS_CACHE_HPP__
+#define TOMOS_CACHE_HPP__
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tomos {
+namespace cache {
+    using Key       = std::uint64_t;
+    using Binary    = std::vector<unsigned char>;
+
+    enum class Status : uint8_t { DISABLED = 0, HIT = 1, MISS = 2 };
+
+    std::ostream&
+    operator<<(std::ostream& os, Status status);
+
+    // FNV-1a over every part, stable across processes and platforms
+    Key
+    hash(const std::vector<std::string>& parts);
+
+    // $TOMOS_CACHE, then $XDG_CACHE_HOME/tomos, then $HOME/.cache/tomos;
+    // an empty path (e.g. TOMOS_CACHE set to "") disables caching
+    std::filesystem::path
+    directory();
+
+    std::optional<Binary>
+    load(const std::filesystem::path& directory, Key key);
+
+    void
+    store(const std::filesystem::path& directory, Key key, const Binary& binary);
+} // namespace cache
+} // namespace tomos
+
+#endif // TOMOS_CACHE_HPP__
@@ -0,0 +1,75 @@
+#ifndef TOMOS_CLUSTER_HPP__
+#define TOMOS_CLUSTER_HPP__
+
+#include "tomos-device.hpp"
+#include "tomos-engine.hpp"
+#include "tomos-metis.hpp"
+#include "tomos-topology.hpp"
+
+namespace tomos {
+    // splits the elements across devices with METIS and assembles every
+    // partition concurrently, one Engine per device
+    class Cluster {
+        public:
+            Cluster(
+                      const tomos::mesh::Mesh&      mesh
+                    , const device::Policy&         policy  = device::Policy::every()
+                    , const kernel::Options&        options = {}
+                   )
+                : Cluster(std::make_shared<Topology>(mesh), device::select(policy), options)
+            {}
+
+            Cluster(
+                      const tomos::mesh::Mesh&      mesh
+                    , const device::Devices&        devices
+                    , const kernel::Options&        options = {}
+                   )
+                : Cluster(std::make_shared<Topology>(mesh), devices, options)
+            {}
+
+            // every engine shares the topology, colors and the sparsity
+            // pattern are computed once for the whole cluster
+            Cluster(
+                      std::shared_ptr<Topology>     topology
+                    , const device::Devices&        devices
+                    , const kernel::Options&        options = {}
+                   )
+            {
+                if (devices.empty()) {
+                    throw std::invalid_argument("cluster requires at least one device");
+                }
+                const metis::Partitions& partitions = topology->partitions(devices.size());
+
+                for (const auto& [partition, elements] : partitions) {
+                    engines_.emplace_back(topology, devices[partition], elements, options);
+                }
+            }
+
+            std::size_t
+            size() const { return engines_.size(); }
+
+            Engine&
+            operator[](std::size_t index) { return engines_[index]; }
+
+            std::vector<float>
+            color() {
+                std::vector<Future<float>> futures;
+                for (Engine& engine : engines_) { futures.push_back(engine.color_async()); }
+
+                std::vector<float> values;
+                for (Future<float>& future : futures) {
+                    std::vector<float> xs = future.get();
+                    if (values.empty()) {
+                        values = std::move(xs);
+                    } else {
+                        for (std::size_t i = 0; i < xs.size(); i++) { values[i] += xs[i]; }
+                    }
+                }
+                return values;
+            }
+        private:
+            std::vector<Engine> engines_;
+    };
+} // namespace tomos
+
+#endif // TOMOS_CLUSTER_HPP__
@@ -1,21 +1,65 @@
 #ifndef TOMOS_COLOR_HPP__
 #define TOMOS_COLOR_HPP__
 
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/edge_coloring.hpp>
-#include <boost/graph/properties.hpp>
-#include <boost/graph/sequential_vertex_coloring.hpp>
+#include <cstdint>
 #include <tomos/tomos-mesh.hpp>
-#include "tomos/tomos-metis.hpp"
+#include <vector>
+
+#include "tomos-metis.hpp"
+#include "tomos-parallel.hpp"
 
 namespace tomos {
 namespace color {
     using Index     = std::size_t;
     using Color     = std::size_t;
-    using Colors    = std::map<std::size_t, Color>;
 
+    // color classes as flat arrays, class c owns order[offsets[c]] to
+    // order[offsets[c + 1] - 1] in ascending element order
+    struct Colors {
+        std::vector<Color>          color;      // color of every element
+        std::vector<std::uint32_t>  order;      // elements sorted by color, uploadable as is
+        std::vector<std::size_t>    offsets;    // count + 1
+
+        std::size_t
+        count() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+        std::size_t
+        size(Color c) const { return offsets[c + 1] - offsets[c]; }
+
+        std::size_t
+        smallest() const;
+
+        std::size_t
+        largest() const;
+
+        bool
+        operator==(const Colors&) const = default;
+    };
+
+    // counting sort of the elements by color, linear in elements and colors
+    Colors
+    classes(std::vector<Color> color);
+
+    struct Options {
+        std::size_t threads = parallel::concurrency();
+        bool        balance = true;     // even out class sizes without adding colors
+    };
+
+    // Jones-Plassmann on the CSR adjacency: every round colors, in parallel,
+    // the uncolored vertices whose hashed priority beats all of their
+    // uncolored neighbours; the result does not depend on the thread count
+    Colors
+    build(const tomos::metis::Dual& dual, const Options& options = {});
+
+    // Jones-Plassmann over element-node incidence, every node keeps a mask of
+    // the colors of its elements so the NODE dual is never built; parallel on
+    // options.threads and independent of the thread count like build
+    Colors
+    incidence(const tomos::mesh::Mesh& mesh, const Options& options = {});
+
+    // NODE goes through incidence, EDGE through the dual
     Colors
-    build(const tomos::mesh::Mesh& mesh, tomos::metis::Common common);
+    build(const tomos::mesh::Mesh& mesh, tomos::metis::Common common, const Options& options = {});
 } // namespace color
 } // namespace tomos
 
@@ -0,0 +1,84 @@
+#ifndef TOMOS_DEVICE_HPP__
+#define TOMOS_DEVICE_HPP__
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tomos-opencl.hpp"
+
+namespace tomos {
+namespace device {
+    using Devices = std::vector<cl::Device>;
+
+    struct Policy {
+        cl_device_type  type    = CL_DEVICE_TYPE_ALL;
+        std::string     vendor  = {};   // substring of CL_DEVICE_VENDOR, empty matches any
+        std::string     name    = {};   // substring of CL_DEVICE_NAME, empty matches any
+        bool            all     = false;
+
+        static Policy
+        gpu() { return {CL_DEVICE_TYPE_GPU}; }
+
+        static Policy
+        cpu() { return {CL_DEVICE_TYPE_CPU}; }
+
+        static Policy
+        every(cl_device_type type = CL_DEVICE_TYPE_ALL) { return {type, {}, {}, true}; }
+    };
+
+    // GPUs first, then accelerators, then everything else (e.g. CPU runtimes)
+    inline std::size_t
+    rank(const cl::Device& device) {
+        cl_device_type type = device.getInfo<CL_DEVICE_TYPE>();
+        if (type & CL_DEVICE_TYPE_GPU)          { return 0; }
+        if (type & CL_DEVICE_TYPE_ACCELERATOR)  { return 1; }
+        return 2;
+    }
+
+    inline bool
+    matches(const cl::Device& device, const Policy& policy) {
+        if (not device.getInfo<CL_DEVICE_AVAILABLE>()) { return false; }
+
+        std::string vendor  = device.getInfo<CL_DEVICE_VENDOR>();
+        std::string name    = device.getInfo<CL_DEVICE_NAME>();
+        return (vendor.find(policy.vendor) != std::string::npos)
+            and (name.find(policy.name) != std::string::npos)
+            ;
+    }
+
+    inline Devices
+    select(const Policy& policy) {
+        std::vector<cl::Platform> platforms;
+        cl::Platform::get(&platforms);
+
+        if (platforms.empty()) {
+            throw std::runtime_error("could not find a valid OpenCL platform");
+        }
+
+        Devices values;
+        for (const cl::Platform& platform : platforms) {
+            Devices devices;
+            platform.getDevices(policy.type, &devices);
+
+            for (const cl::Device& device : devices) {
+                if (matches(device, policy)) { values.push_back(device); }
+            }
+        }
+        if (values.empty()) {
+            throw std::runtime_error("could not find a valid OpenCL device");
+        }
+        std::stable_sort(
+                  values.begin()
+                , values.end()
+                , [](const cl::Device& lhs, const cl::Device& rhs) { return rank(lhs) < rank(rhs); }
+                );
+        if (not policy.all) { values.resize(1); }
+
+        return values;
+    }
+} // namespace device
+} // namespace tomos
+
+#endif // TOMOS_DEVICE_HPP__
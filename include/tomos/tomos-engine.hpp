@@ -1,15 +1,24 @@
 #ifndef TOMOS_ENGINE_HPP__
 #define TOMOS_ENGINE_HPP__
 
-#define CL_HPP_TARGET_OPENCL_VERSION 300
-#define CL_HPP_ENABLE_EXCEPTIONS
-#include <CL/opencl.hpp>
+#include <bit>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <span>
 #include <tomos/tomos-mesh.hpp>
 
+#include "tomos-backend.hpp"
+#include "tomos-cache.hpp"
 #include "tomos-color.hpp"
+#include "tomos-device.hpp"
+#include "tomos-kernel.hpp"
+#include "tomos-opencl.hpp"
+#include "tomos-partition.hpp"
 #include "tomos-sparse.hpp"
+#include "tomos-topology.hpp"
 
 namespace tomos {
     struct Memory {
@@ -32,137 +41,681 @@ namespace tomos {
         }
     };
 
-    class Engine {
+    using Events = std::vector<cl::Event>;
+
+    // host result of a non-blocking read; destroying or overwriting a pending
+    // future waits for the read so the device never writes into freed memory
+    template <typename T>
+    class [[nodiscard]] Future {
+        public:
+            explicit Future(std::size_t count) : values_(count) {}
+
+            Future(const Future&)               = delete;
+            Future(Future&&)                    = default;
+            Future& operator=(const Future&)    = delete;
+
+            Future&
+            operator=(Future&& other) {
+                if (this != &other) {
+                    this->settle();
+                    values_ = std::move(other.values_);
+                    event_  = std::move(other.event_);
+                }
+                return *this;
+            }
+
+            ~Future() { this->settle(); }
+
+            const cl::Event&
+            event() const { return event_; }
+
+            void
+            wait() const { event_.wait(); }
+
+            std::vector<T>
+            get() {
+                this->wait();
+                return std::move(values_);
+            }
+        private:
+            friend class Engine;
+
+            // errors are reported by wait() and get(), never from a destructor
+            void
+            settle() noexcept {
+                if (not event_()) { return; }
+                try { event_.wait(); } catch (...) {}
+            }
+
+            std::vector<T>  values_;
+            cl::Event       event_;
+    };
+
+    // device-resident result, only crosses to the host through Engine::download
+    template <typename T>
+    class Handle {
+        public:
+            Handle(const cl::Buffer& buffer, std::size_t count, const cl::Event& event)
+                : buffer_(buffer)
+                , count_(count)
+                , event_(event)
+            {}
+
+            const cl::Buffer&
+            buffer() const { return buffer_; }
+
+            std::size_t
+            size() const { return count_; }
+
+            const cl::Event&
+            event() const { return event_; }
+        private:
+            cl::Buffer  buffer_;
+            std::size_t count_;
+            cl::Event   event_;
+    };
+
+    struct Geometry {
+        // structure-of-arrays result of the fused geometry kernel
+        struct Resident {
+            Handle<float>                   area;
+            Handle<tomos::mesh::Node>       centroid;
+            Handle<tomos::mesh::Node>       normal;
+            std::optional<Handle<float>>    aspect;
+        };
+
+        std::vector<float>              area;
+        std::vector<tomos::mesh::Node>  centroid;
+        std::vector<tomos::mesh::Node>  normal;
+        std::vector<float>              aspect;     // empty unless quality was requested
+    };
+
+    // COLOR launches once per color class, ATOMIC once over every element with
+    // atomic scatter, REDUCE writes element matrices and sums them per nonzero,
+    // TILED assembles every partition in local memory with one work-group each
+    enum class Strategy : uint8_t { COLOR = 0, ATOMIC = 1, REDUCE = 2, TILED = 3 };
+
+    // color-sorted element layout, reused by every stiffness assembly of a mesh
+    struct Plan {
+        cl::Buffer                  elements;   // triangle records, grouped by color
+        std::vector<std::size_t>    offsets;    // color c spans [offsets[c], offsets[c + 1])
+        cl::Buffer                  values;     // sparse values, overwritten by each assembly
+        std::size_t                 nonzeros;
+
+        // Strategy::REDUCE only
+        cl::Buffer                  matrices;   // 9 entries per element, in plan order
+        cl::Buffer                  segments;   // nonzero k sums sources [segments[k], segments[k + 1])
+        cl::Buffer                  sources;    // positions into matrices
+
+        // Strategy::TILED only, elements holds tile records and offsets the
+        // element range of every partition
+        cl::Buffer                  blocks;     // one record per partition
+        cl::Buffer                  maps;       // local to global nodes, partition by partition
+        cl::Buffer                  slots;      // local to global nonzeros, exclusive ones first
+        std::size_t                 cache;      // largest node count of a partition
+        std::size_t                 block;      // largest nonzero count of a partition
+    };
+
+    // device copy of the pattern of Engine::storage() in the format used for y = A x
+    struct Product {
+        sparse::Format              format;
+        std::size_t                 nodes;
+        std::size_t                 nonzeros;
+        std::size_t                 width;      // lanes per row, Format::VECTOR
+        cl::Buffer                  rows;       // CSR offsets, or the row of every slot for SELL
+        cl::Buffer                  cols;
+
+        // Format::SELL only, values are packed into the sliced layout once
+        // per assembly and reused while the same handle is multiplied
+        std::size_t                 chunk;
+        std::size_t                 entries;    // stored entries, padding included
+        cl::Buffer                  slices;
+        cl::Buffer                  widths;
+        cl::Buffer                  sources;    // CSR value of every entry, UINT_MAX for padding
+        cl::Buffer                  packed;     // values in the sliced layout
+        cl::Buffer                  origin;     // values handle of the last packing
+        cl::Event                   assembly;   // and its event
+        cl::Event                   ready;      // end of the last packing
+    };
+
+    class Engine : public Backend {
         struct __attribute__ ((packed)) Triangle {
             cl_uint3 nodes;
+            cl_uint  element;
             cl_float resistivity;
             cl_uint  indices[9];
         };
-        using Coordinates = std::map<sparse::Coordinate, sparse::Index>;
+        struct __attribute__ ((packed)) Tile {
+            cl_ushort nodes[3];
+            cl_ushort slots[9];
+            cl_uint   element;
+            cl_float  resistivity;
+        };
+        struct Block {
+            cl_uint element;
+            cl_uint elements;
+            cl_uint node;
+            cl_uint nodes;
+            cl_uint slot;
+            cl_uint slots;
+            cl_uint exclusive;
+        };
         public:
-            Engine(const std::filesystem::path& path, const tomos::mesh::Mesh& mesh)
-                : device_(Engine::device(CL_DEVICE_TYPE_GPU))
+            Engine(
+                      const tomos::mesh::Mesh&      mesh
+                    , const device::Policy&         policy  = {}
+                    , const kernel::Options&        options = {}
+                  )
+                : Engine(std::make_shared<Topology>(mesh), policy, options)
+            {}
+
+            Engine(
+                      std::shared_ptr<Topology>     topology
+                    , const device::Policy&         policy  = {}
+                    , const kernel::Options&        options = {}
+                  )
+                : Engine(std::move(topology), device::select(policy).front(), options)
+            {}
+
+            Engine(
+                      const tomos::mesh::Mesh&      mesh
+                    , const cl::Device&             device
+                    , const kernel::Options&        options = {}
+                  )
+                : Engine(std::make_shared<Topology>(mesh), device, options)
+            {}
+
+            Engine(
+                      std::shared_ptr<Topology>     topology
+                    , const cl::Device&             device
+                    , const kernel::Options&        options = {}
+                  )
+                : Engine(topology, device, Engine::everything(topology->mesh()), options)
+            {}
+
+            // restricts stiffness assembly to a subset of the elements, the
+            // values still index the sparsity pattern of the whole mesh
+            Engine(
+                      const tomos::mesh::Mesh&      mesh
+                    , const cl::Device&             device
+                    , const partition::Indices&     subset
+                    , const kernel::Options&        options = {}
+                  )
+                : Engine(std::make_shared<Topology>(mesh), device, subset, options)
+            {}
+
+            Engine(
+                      std::shared_ptr<Topology>     topology
+                    , const cl::Device&             device
+                    , const partition::Indices&     subset
+                    , const kernel::Options&        options = {}
+                  )
+                : device_(device)
                 , context_(device_)
                 , memory_(Engine::memory(device_))
-                , mesh_(mesh)
+                , queue_(context_, device_)
+                , topology_(std::move(topology))
+                , subset_(subset)
+                , storage_(options.symmetric ? sparse::Storage::UPPER : sparse::Storage::FULL)
             {
-                nodes_      = this->nodes(mesh);
-                elements_   = this->indices(mesh);
+                nodes_      = this->nodes(topology_->mesh());
+                elements_   = this->indices(topology_->mesh(), options);
 
-                program_ = cl::Program(context_, Engine::kernel(path));
-                program_.build();
+                program_ = this->program(kernel::source(options), kernel::build(options));
 
-                area_       = cl::Kernel(program_, "area");
-                centroid_   = cl::Kernel(program_, "centroid");
-                normal_     = cl::Kernel(program_, "normal");
-                stiffness_  = cl::Kernel(program_, "stiffness");
+                area_        = cl::Kernel(program_, "area");
+                centroid_    = cl::Kernel(program_, "centroid");
+                normal_      = cl::Kernel(program_, "normal");
+                geometry_    = cl::Kernel(program_, "geometry");
+                stiffness_   = cl::Kernel(program_, "stiffness");
+                atomic_      = cl::Kernel(program_, "stiffness_atomic");
+                element_     = cl::Kernel(program_, "stiffness_element");
+                reduce_      = cl::Kernel(program_, "reduce");
+                tiled_       = cl::Kernel(program_, "stiffness_tiled");
+                scalar_      = cl::Kernel(program_, "spmv_scalar");
+                vector_      = cl::Kernel(program_, "spmv_vector");
+                sell_        = cl::Kernel(program_, "spmv_sell");
+                upper_       = cl::Kernel(program_, "spmv_upper");
+                pack_        = cl::Kernel(program_, "sell_pack");
             }
 
             std::vector<float>
-            area() {
-                std::size_t elements = mesh_.elements.size();
-                cl::Buffer values = this->buffer<float>(elements, CL_MEM_READ_WRITE);
+            area() override { return this->area_async().get(); }
+
+            std::vector<tomos::mesh::Node>
+            centroid() override { return this->centroid_async().get(); }
+
+            std::vector<tomos::mesh::Node>
+            normal() override { return this->normal_async().get(); }
+
+            std::vector<float>
+            color() override { return this->color_async().get(); }
 
-                area_.setArg(0, nodes_);
-                area_.setArg(1, elements_);
-                area_.setArg(2, values);
+            Geometry
+            geometry(bool quality = false) {
+                Geometry::Resident resident = this->geometry_device(quality);
 
-                cl::CommandQueue queue(context_, device_);
-                queue.enqueueNDRangeKernel(area_, cl::NullRange, elements, cl::NullRange);
+                Future<float> area                  = this->download(resident.area);
+                Future<tomos::mesh::Node> centroid  = this->download(resident.centroid);
+                Future<tomos::mesh::Node> normal    = this->download(resident.normal);
 
-                return this->read<float>(queue, values, elements);
+                Geometry values;
+                if (resident.aspect) { values.aspect = this->download(*resident.aspect).get(); }
+                values.area     = area.get();
+                values.centroid = centroid.get();
+                values.normal   = normal.get();
+                return values;
             }
 
-            std::vector<tomos::mesh::Node>
-            centroid() {
-                std::size_t elements    = mesh_.elements.size();
-                cl::Buffer values       = this->buffer<cl_float3>(elements, CL_MEM_READ_WRITE);
+            // one launch gathering each element once, instead of one per quantity
+            Geometry::Resident
+            geometry_device(bool quality = false, const Events& events = {}) {
+                std::size_t elements    = topology_->mesh().elements.size();
+                cl::Buffer areas        = this->buffer<float>(elements, CL_MEM_READ_WRITE);
+                cl::Buffer centroids    = this->buffer<cl_float3>(elements, CL_MEM_READ_WRITE);
+                cl::Buffer normals      = this->buffer<cl_float3>(elements, CL_MEM_READ_WRITE);
+                cl::Buffer aspects      = quality ? this->buffer<float>(elements, CL_MEM_READ_WRITE) : cl::Buffer();
+
+                geometry_.setArg(0, nodes_);
+                geometry_.setArg(1, elements_);
+                geometry_.setArg(2, areas);
+                geometry_.setArg(3, centroids);
+                geometry_.setArg(4, normals);
+                geometry_.setArg(5, aspects);   // a null buffer skips the quality metrics
 
-                centroid_.setArg(0, nodes_);
-                centroid_.setArg(1, elements_);
-                centroid_.setArg(2, values);
+                cl::Event event;
+                queue_.enqueueNDRangeKernel(geometry_, cl::NullRange, elements, cl::NullRange, &events, &event);
 
-                cl::CommandQueue queue(context_, device_);
-                queue.enqueueNDRangeKernel(centroid_, cl::NullRange, elements, cl::NullRange);
-                return this->read<cl_float3>(queue, values, elements);
+                Geometry::Resident values = {
+                      {areas, elements, event}
+                    , {centroids, elements, event}
+                    , {normals, elements, event}
+                    , std::nullopt
+                };
+                if (quality) { values.aspect = Handle<float>(aspects, elements, event); }
+                return values;
             }
 
-             std::vector<tomos::mesh::Node>
-             normal() {
-                std::size_t elements    = mesh_.elements.size();
-                cl::Buffer values       = this->buffer<cl_float3>(elements, CL_MEM_READ_WRITE);
+            [[nodiscard]] Future<float>
+            area_async(const Events& events = {}) {
+                return this->download(this->area_device(events));
+            }
 
-                normal_.setArg(0, nodes_);
-                normal_.setArg(1, elements_);
-                normal_.setArg(2, values);
+            [[nodiscard]] Future<tomos::mesh::Node>
+            centroid_async(const Events& events = {}) {
+                return this->download(this->centroid_device(events));
+            }
 
-                cl::CommandQueue queue(context_, device_);
-                queue.enqueueNDRangeKernel(normal_, cl::NullRange, elements, cl::NullRange);
-                return this->read<cl_float3>(queue, values, elements);
-             }
+            [[nodiscard]] Future<tomos::mesh::Node>
+            normal_async(const Events& events = {}) {
+                return this->download(this->normal_device(events));
+            }
+
+            [[nodiscard]] Future<float>
+            color_async(const Events& events = {}) {
+                return this->download(this->color_device(events));
+            }
+
+            Handle<float>
+            area_device(const Events& events = {}) {
+                return this->launch<float>(area_, events);
+            }
+
+            Handle<tomos::mesh::Node>
+            centroid_device(const Events& events = {}) {
+                return this->launch<cl_float3>(centroid_, events);
+            }
+
+            Handle<tomos::mesh::Node>
+            normal_device(const Events& events = {}) {
+                return this->launch<cl_float3>(normal_, events);
+            }
+
+            // the handle aliases the plan's value buffer, the next assembly overwrites it
+            Handle<float>
+            color_device(const Events& events = {}) {
+                return this->scatter(cl::Buffer(), cl::Buffer(), events);
+            }
 
+            // assembles the stiffness matrix reusing per-element areas already on the device
+            Handle<float>
+            color_device(const Handle<float>& area, const Events& events = {}) {
+                if (area.size() != topology_->mesh().elements.size()) {
+                    throw std::invalid_argument("area handle does not match the number of elements");
+                }
+                Events waits = events;
+                waits.push_back(area.event());
+
+                return this->scatter(area.buffer(), cl::Buffer(), waits);
+            }
+
+            std::vector<float>
+            stiffness(std::span<const float> conductivity) override {
+                return this->download(this->assemble(conductivity)).get();
+            }
+
+            // uploads only the conductivity, pattern, colors and scatter
+            // indices all come from the plan built by the first assembly
+            Handle<float>
+            assemble(std::span<const float> conductivity, const Events& events = {}) {
+                std::size_t elements = topology_->mesh().elements.size();
+                if (conductivity.size() != elements) {
+                    throw std::invalid_argument("conductivity does not match the number of elements");
+                }
+                if (not conductivity_()) {
+                    conductivity_ = this->buffer<float>(elements, CL_MEM_READ_ONLY);
+                }
+                // the staging copy outlives the non-blocking write, wait for the
+                // previous upload before reusing it
+                if (staged_()) { staged_.wait(); }
+                staging_.assign(conductivity.begin(), conductivity.end());
+
+                queue_.enqueueWriteBuffer(conductivity_, CL_FALSE, 0, elements * sizeof(float), staging_.data(), &events, &staged_);
+
+                return this->scatter(cl::Buffer(), conductivity_, {staged_});
+            }
+
+            // y = A x with the values of an assembly; UPPER storage mirrors the
+            // upper triangle with atomics and always runs Format::SCALAR
             std::vector<float>
-            color() {
-                std::vector<float> values(sparse::nonzeros(mesh_), 0.0f);
+            multiply(const Handle<float>& values, std::span<const float> x) {
+                return this->download(this->multiply_device(values, this->upload(x))).get();
+            }
 
-                using Color         = tomos::color::Color;
-                using Index         = tomos::color::Index;
-                using Indices       = std::vector<Index>;
+            Handle<float>
+            multiply_device(const Handle<float>& values, const Handle<float>& x, const Events& events = {}) {
+                Product& product = this->product();
+                if (values.size() != product.nonzeros) {
+                    throw std::invalid_argument("values do not match the sparsity pattern");
+                }
+                if (x.size() != product.nodes) {
+                    throw std::invalid_argument("vector does not match the number of nodes");
+                }
+                cl::Buffer y = this->buffer<float>(std::max<std::size_t>(1, product.nodes), CL_MEM_READ_WRITE);
 
-                tomos::color::Colors cs = tomos::color::build(mesh_, tomos::metis::Common::NODE);
+                Events waits = events;
+                waits.push_back(values.event());
+                waits.push_back(x.event());
 
-                std::map<Color, Indices> colors;
-                for (const auto& [element, color] : cs) {
-                    auto [it, inserted] = colors.insert({color, {element}});
-                    if (not inserted) { it->second.push_back(element); }
+                cl::Event event;
+                if (product.nodes == 0) {
+                    queue_.enqueueMarkerWithWaitList(&waits, &event);
+                    return {y, product.nodes, event};
                 }
+                if (storage_ == sparse::Storage::UPPER) {
+                    cl::Event fill;
+                    queue_.enqueueFillBuffer(y, 0.0f, 0, product.nodes * sizeof(float), &waits, &fill);
+                    waits = {fill};
 
-                cl::Buffer sparse   = this->buffer(values, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR);
-                cl::CommandQueue queue(context_, device_);
-
-                Coordinates coo  = sparse::coo(mesh_);
-                for (const auto& [color, es] : colors) {
-                    std::vector<Triangle> vs(es.size());
-                    for (std::size_t i = 0; i < es.size(); i++) {
-                        const tomos::mesh::Element& e = mesh_.elements[es[i]];
-                        vs[i].nodes         = {{e.nodes[0], e.nodes[1], e.nodes[2]}};
-                        vs[i].resistivity   = 1.0;
-                        std::vector<cl_uint> nz = Engine::nonzero(e, coo);
-                        std::copy(nz.begin(), nz.end(), vs[i].indices);
+                    upper_.setArg(0, static_cast<ulong>(product.nodes));
+                    upper_.setArg(1, product.rows);
+                    upper_.setArg(2, product.cols);
+                    upper_.setArg(3, values.buffer());
+                    upper_.setArg(4, x.buffer());
+                    upper_.setArg(5, y);
+                    queue_.enqueueNDRangeKernel(upper_, cl::NullRange, product.nodes, cl::NullRange, &waits, &event);
+                    return {y, product.nodes, event};
+                }
+                switch (product.format) {
+                    case sparse::Format::SCALAR:
+                    case sparse::Format::VECTOR:
+                    {
+                        cl::Kernel& kernel = (product.format == sparse::Format::SCALAR) ? scalar_ : vector_;
+                        kernel.setArg(0, static_cast<ulong>(product.nodes));
+                        kernel.setArg(1, product.rows);
+                        kernel.setArg(2, product.cols);
+                        kernel.setArg(3, values.buffer());
+                        kernel.setArg(4, x.buffer());
+                        kernel.setArg(5, y);
+                        if (product.format == sparse::Format::SCALAR) {
+                            queue_.enqueueNDRangeKernel(kernel, cl::NullRange, product.nodes, cl::NullRange, &waits, &event);
+                        } else {
+                            kernel.setArg(6, cl::Local(product.width * sizeof(float)));
+                            queue_.enqueueNDRangeKernel(kernel, cl::NullRange, product.nodes * product.width, product.width, &waits, &event);
+                        }
+                        break;
                     }
+                    case sparse::Format::SELL:
+                    {
+                        // a new assembly or values buffer is packed before its first product
+                        bool stale = not product.ready() or product.origin() != values.buffer()()
+                                  or product.assembly() != values.event()();
+                        if (stale) {
+                            pack_.setArg(0, static_cast<ulong>(product.entries));
+                            pack_.setArg(1, product.sources);
+                            pack_.setArg(2, values.buffer());
+                            pack_.setArg(3, product.packed);
 
-                    cl::Buffer elements = this->buffer(vs, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
-                    stiffness_.setArg(0, static_cast<ulong>(es.size()));
-                    stiffness_.setArg(1, nodes_);
-                    stiffness_.setArg(2, elements);
-                    stiffness_.setArg(3, sparse);
+                            Events inputs = {values.event()};
+                            queue_.enqueueNDRangeKernel(pack_, cl::NullRange, std::max<std::size_t>(1, product.entries), cl::NullRange, &inputs, &product.ready);
+                            product.origin      = values.buffer();
+                            product.assembly    = values.event();
+                        }
+                        waits.push_back(product.ready);
 
-                    queue.enqueueNDRangeKernel(stiffness_, cl::NullRange, es.size(), cl::NullRange);
+                        sell_.setArg(0, static_cast<ulong>(product.nodes));
+                        sell_.setArg(1, static_cast<cl_uint>(product.chunk));
+                        sell_.setArg(2, product.rows);
+                        sell_.setArg(3, product.slices);
+                        sell_.setArg(4, product.widths);
+                        sell_.setArg(5, product.cols);
+                        sell_.setArg(6, product.packed);
+                        sell_.setArg(7, x.buffer());
+                        sell_.setArg(8, y);
+                        queue_.enqueueNDRangeKernel(sell_, cl::NullRange, product.nodes, cl::NullRange, &waits, &event);
+                        break;
+                    }
                 }
-                queue.enqueueReadBuffer(sparse, CL_TRUE, 0, values.size() * sizeof(float), values.data());
-                return values;
+                return {y, product.nodes, event};
+            }
+
+            // copies xs into a new device buffer before returning
+            Handle<float>
+            upload(std::span<const float> xs) {
+                float zero = 0.0f;
+                cl::Buffer buffer(
+                          context_
+                        , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
+                        , std::max<std::size_t>(1, xs.size()) * sizeof(float)
+                        , xs.empty() ? &zero : const_cast<float*>(xs.data())
+                        );
+                cl::Event event;
+                queue_.enqueueMarkerWithWaitList(nullptr, &event);
+                return {buffer, xs.size(), event};
             }
-        private:
-            static cl::Device
-            device(cl_device_type model) {
-                std::vector<cl::Platform> platforms;
-                cl::Platform::get(&platforms);
 
-                if (platforms.empty()) {
-                    throw std::runtime_error("could not find a valid OpenCL platform");
+            // chosen from the row lengths on first use unless set
+            sparse::Format
+            format() { return this->product().format; }
+
+            void
+            format(sparse::Format format) {
+                if (format != format_) { product_.reset(); }
+                format_ = format;
+            }
+
+            template <typename T>
+            [[nodiscard]] Future<T>
+            download(const Handle<T>& handle, const Events& events = {}) {
+                Future<T> future(handle.size());
+
+                Events waits = events;
+                waits.push_back(handle.event());
+
+                std::vector<T>& xs = future.values_;
+                queue_.enqueueReadBuffer(handle.buffer(), CL_FALSE, 0, xs.size() * sizeof(T), xs.data(), &waits, &future.event_);
+                queue_.flush();
+                return future;
+            }
+
+            void
+            finish() { queue_.finish(); }
+
+            // whether this engine's program was loaded from the binary cache
+            cache::Status
+            cache() const { return cache_; }
+
+            Strategy
+            strategy() const { return strategy_; }
+
+            // FULL, or UPPER when built with kernel::Options::symmetric; values
+            // follow topology()->pattern(storage())
+            sparse::Storage
+            storage() const { return storage_; }
+
+            const std::shared_ptr<Topology>&
+            topology() const { return topology_; }
+
+            // switching strategies discards the plan, it is rebuilt by the next assembly
+            void
+            strategy(Strategy strategy) {
+                if (strategy != strategy_) { plan_.reset(); }
+                strategy_ = strategy;
+            }
+
+            // caps the nodes of a TILED partition below what local memory
+            // allows, discarding a TILED plan
+            void
+            tile(std::size_t limit) {
+                if (limit != tile_ and strategy_ == Strategy::TILED) { plan_.reset(); }
+                tile_ = limit;
+            }
+
+            // built on first use, every later assembly only launches kernels
+            const Plan&
+            plan() {
+                if (plan_) { return *plan_; }
+                if (strategy_ == Strategy::TILED) {
+                    plan_ = this->tiling();
+                    return *plan_;
                 }
 
-                for (const cl::Platform& platform : platforms) {
-                    std::vector<cl::Device> devices;
-                    platform.getDevices(model, &devices);
+                const tomos::mesh::Mesh& mesh       = topology_->mesh();
+                const tomos::color::Colors& colors  = topology_->colors(tomos::metis::Common::NODE);
+
+                std::vector<bool> member(mesh.elements.size(), false);
+                for (const partition::Index& element : subset_) { member[element] = true; }
 
-                    for (const cl::Device& device : devices) {
-                        if (not device.getInfo<CL_DEVICE_AVAILABLE>()) { continue; }
-                        return device;
+                const std::vector<cl_uint>& slots   = topology_->scatter(storage_);
+                const std::size_t entries           = sparse::entries(3, storage_);
+
+                std::vector<Triangle> vs;
+                vs.reserve(subset_.size());
+
+                Plan plan;
+                plan.offsets    = {0};
+                plan.nonzeros   = topology_->pattern(storage_).cols.size();
+                for (tomos::color::Color color = 0; color < colors.count(); color++) {
+                    for (std::size_t i = colors.offsets[color]; i < colors.offsets[color + 1]; i++) {
+                        const std::uint32_t element = colors.order[i];
+                        if (not member[element]) { continue; }
+                        const tomos::mesh::Element& e = mesh.elements[element];
+
+                        Triangle t;
+                        t.nodes         = {{e.nodes[0], e.nodes[1], e.nodes[2]}};
+                        t.element       = static_cast<cl_uint>(element);
+                        t.resistivity   = 1.0;
+                        std::copy_n(slots.begin() + entries * element, entries, t.indices);
+
+                        vs.push_back(t);
                     }
+                    plan.offsets.push_back(vs.size());
                 }
-                throw std::runtime_error("could not find a valid OpenCL device");
-                return {};
+                // zero-sized buffers are invalid, an empty subset still gets one element
+                if (vs.empty()) { vs.resize(1); }
+
+                if (strategy_ == Strategy::REDUCE) {
+                    // counting sort of every element matrix entry by destination nonzero
+                    std::vector<cl_uint> segments(plan.nonzeros + 1, 0);
+                    // placeholder records of an empty subset are never assembled
+                    for (std::size_t i = 0; i < plan.offsets.back(); i++) {
+                        for (std::size_t j = 0; j < entries; j++) { segments[vs[i].indices[j] + 1]++; }
+                    }
+                    std::partial_sum(segments.begin(), segments.end(), segments.begin());
+
+                    std::vector<cl_uint> sources(segments.back());
+                    std::vector<cl_uint> cursor(segments.begin(), segments.end() - 1);
+                    for (std::size_t i = 0; i < plan.offsets.back(); i++) {
+                        for (std::size_t j = 0; j < entries; j++) {
+                            sources[cursor[vs[i].indices[j]]++] = static_cast<cl_uint>(entries * i + j);
+                        }
+                    }
+                    if (sources.empty()) { sources.resize(1); }
+
+                    plan.matrices   = this->buffer<float>(entries * vs.size(), CL_MEM_READ_WRITE);
+                    plan.segments   = this->buffer(segments, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
+                    plan.sources    = this->buffer(sources, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
+                }
+
+                plan.elements   = this->buffer(vs, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
+                plan.values     = this->buffer<float>(plan.nonzeros, CL_MEM_READ_WRITE);
+
+                plan_ = std::move(plan);
+                return *plan_;
+            }
+        private:
+            Product&
+            product() {
+                if (product_) { return *product_; }
+                const bool upper = (storage_ == sparse::Storage::UPPER);
+                if (upper and format_ and *format_ != sparse::Format::SCALAR) {
+                    throw std::domain_error("UPPER storage multiplies in the SCALAR format only");
+                }
+                using Index = Topology::Index;
+                const sparse::Pattern<Index>& pattern = topology_->pattern(storage_);
+
+                // VECTOR lanes from vector_, the SELL chunk from sell_
+                std::size_t warp    = vector_.getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE>(device_);
+                std::size_t limit   = vector_.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device_);
+                std::size_t chunk   = sell_.getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE>(device_);
+                warp                = std::max<std::size_t>(1, warp);
+                chunk               = std::max<std::size_t>(1, chunk);
+
+                // the O(nonzeros) conversion only when SELL may be used; sparse::sell
+                // needs FULL storage
+                bool sliced = not upper and (not format_ or *format_ == sparse::Format::SELL);
+                sparse::Sell<Index> sell    = sliced ? sparse::sell(pattern, chunk) : sparse::Sell<Index>{};
+                sparse::Format format       = upper ? sparse::Format::SCALAR
+                                            : format_.value_or(sparse::select(sparse::lengths(pattern), sell.fill(), warp));
+
+                Product product;
+                product.format      = format;
+                product.nodes       = pattern.rows.size() - 1;
+                product.nonzeros    = pattern.cols.size();
+                product.width       = std::bit_floor(std::max<std::size_t>(1, std::min(warp, limit)));
+                product.chunk       = sell.chunk;
+
+                // copied when the buffer is created, an empty array still gets one entry
+                Index zero = 0;
+                auto upload = [&](const std::vector<Index>& xs) {
+                    return cl::Buffer(
+                              context_
+                            , CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR
+                            , std::max<std::size_t>(1, xs.size()) * sizeof(Index)
+                            , xs.empty() ? &zero : const_cast<Index*>(xs.data())
+                            );
+                };
+                if (format == sparse::Format::SELL) {
+                    product.rows    = upload(sell.rows);
+                    product.cols    = upload(sell.cols);
+                    product.slices  = upload(sell.slices);
+                    product.widths  = upload(sell.widths);
+                    product.sources = upload(sell.sources);
+                    product.entries = sell.cols.size();
+                    product.packed  = this->buffer<float>(std::max<std::size_t>(1, product.entries), CL_MEM_READ_WRITE);
+                } else {
+                    product.rows    = upload(pattern.rows);
+                    product.cols    = upload(pattern.cols);
+                }
+                product_ = std::move(product);
+                return *product_;
+            }
+
+            static partition::Indices
+            everything(const tomos::mesh::Mesh& mesh) {
+                partition::Indices values(mesh.elements.size());
+                std::iota(values.begin(), values.end(), 0);
+                return values;
             }
 
             static Memory
@@ -173,17 +726,42 @@ namespace tomos {
                 };
             }
 
-            static std::string
-            kernel(const std::filesystem::path& path) {
-                std::ifstream handle(path);
-                if (not handle.is_open()) {
-                    throw std::runtime_error("could not load OpenCL kernel");
+            cl::Program
+            program(const std::string& source, const std::string& options) {
+                std::filesystem::path directory = cache::directory();
+                cache::Key key                  = cache::hash({
+                      source
+                    , options
+                    , device_.getInfo<CL_DEVICE_NAME>()
+                    , device_.getInfo<CL_DEVICE_VENDOR>()
+                    , device_.getInfo<CL_DEVICE_VERSION>()
+                    , device_.getInfo<CL_DRIVER_VERSION>()
+                });
+
+                if (std::optional<cache::Binary> binary = cache::load(directory, key)) {
+                    try {
+                        cl::Program program(context_, {device_}, {*binary});
+                        program.build(options.c_str());
+
+                        cache_ = cache::Status::HIT;
+                        return program;
+                    } catch (const cl::Error&) {
+                        // stale or foreign binary, rebuilt from source below
+                    }
                 }
 
-                std::stringstream ss;
-                ss << handle.rdbuf();
+                cl::Program program(context_, source);
+                program.build(options.c_str());
 
-                return ss.str();
+                if (directory.empty()) {
+                    cache_ = cache::Status::DISABLED;
+                } else {
+                    cache_ = cache::Status::MISS;
+
+                    std::vector<cache::Binary> binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+                    if (not binaries.empty()) { cache::store(directory, key, binaries.front()); }
+                }
+                return program;
             }
 
             template <typename T>
@@ -209,9 +787,12 @@ namespace tomos {
             }
 
             cl::Buffer
-            indices(const tomos::mesh::Mesh& mesh) {
+            indices(const tomos::mesh::Mesh& mesh, const kernel::Options& options) {
                 std::vector<cl_uint> xs;
                 for (const tomos::mesh::Element& e : mesh.elements) {
+                    if (e.nodes.size() != options.nodes) {
+                        throw std::domain_error("element does not match the kernel specialization");
+                    }
                     xs.insert(xs.end(), e.nodes.begin(), e.nodes.end());
                 }
 
@@ -219,42 +800,288 @@ namespace tomos {
             }
 
             template <typename T>
-            std::vector<T>
-            read(const cl::CommandQueue& queue, const cl::Buffer& buffer, std::size_t count) {
-                std::vector<T> xs(count);
-                queue.enqueueReadBuffer(buffer, CL_TRUE, 0, count * sizeof(T), xs.data());
-                return xs;
-            }
-
-            static std::vector<cl_uint>
-            nonzero(const mesh::Element& element, const Coordinates& coo) {
-                const std::vector<mesh::node::Number>& nodes    = element.nodes;
-                std::size_t count                               = nodes.size();
-
-                std::vector<cl_uint> ii(count * count);
-                for (std::size_t i = 0; i < count; i++) {
-                    for (std::size_t j = 0; j < count; j++) {
-                        std::size_t offset  = i * 3 + j;
-                        ii[offset]          = coo.find({nodes[i], nodes[j]})->second;
+            Handle<T>
+            launch(cl::Kernel& kernel, const Events& events) {
+                std::size_t elements    = topology_->mesh().elements.size();
+                cl::Buffer values       = this->buffer<T>(elements, CL_MEM_READ_WRITE);
+
+                kernel.setArg(0, nodes_);
+                kernel.setArg(1, elements_);
+                kernel.setArg(2, values);
+
+                cl::Event event;
+                queue_.enqueueNDRangeKernel(kernel, cl::NullRange, elements, cl::NullRange, &events, &event);
+                return {values, elements, event};
+            }
+
+            // partitions whose nodes and matrix block fit the local memory,
+            // found by bisecting with a shrinking node limit
+            Plan
+            tiling() {
+                const tomos::mesh::Mesh& mesh       = topology_->mesh();
+                const metis::Dual& dual             = topology_->dual(metis::Common::EDGE);
+                const std::vector<cl_uint>& scatter = topology_->scatter(storage_);
+                const std::size_t entries           = sparse::entries(3, storage_);
+                const std::size_t nonzeros          = topology_->pattern(storage_).cols.size();
+                const std::size_t unused            = std::numeric_limits<std::size_t>::max();
+
+                std::vector<bool> member(mesh.elements.size(), false);
+                for (const partition::Index& element : subset_) { member[element] = true; }
+
+                // a node costs its coordinates plus its share of the nonzeros
+                const std::size_t local     = memory_.local;
+                const std::size_t row       = mesh.nodes.empty() ? 1 : nonzeros / mesh.nodes.size() + 1;
+                const std::size_t capacity  = std::size_t{std::numeric_limits<cl_ushort>::max()} + 1;
+                std::size_t limit           = std::min(capacity, local / (sizeof(cl_float3) + row * sizeof(float)));
+                if (tile_) { limit = std::min(limit, *tile_); }
+
+                // one pool serves every retry
+                parallel::Pool pool;
+                while (true) {
+                    if (limit < 3) { throw std::runtime_error("local memory too small for a tile"); }
+
+                    partition::Layout whole = partition::bisection(dual, mesh, limit);
+                    partition::Layout layout;
+                    layout.offsets = {0};
+                    for (std::size_t p = 0; p + 1 < whole.offsets.size(); p++) {
+                        for (std::size_t i = whole.offsets[p]; i < whole.offsets[p + 1]; i++) {
+                            if (member[whole.elements[i]]) { layout.elements.push_back(whole.elements[i]); }
+                        }
+                        if (layout.elements.size() != layout.offsets.back()) { layout.offsets.push_back(layout.elements.size()); }
+                    }
+                    std::vector<partition::Submesh> submeshes = partition::submeshes(mesh, layout, pool);
+
+                    // nonzeros written by more than one partition need atomics in the merge
+                    std::vector<std::size_t> owner(nonzeros, unused);
+                    std::vector<bool> shared(nonzeros, false);
+                    for (std::size_t p = 0; p < submeshes.size(); p++) {
+                        for (const partition::Index& element : submeshes[p].elements) {
+                            for (std::size_t j = 0; j < entries; j++) {
+                                cl_uint slot = scatter[entries * element + j];
+                                if (owner[slot] == unused) { owner[slot] = p; }
+                                else if (owner[slot] != p) { shared[slot] = true; }
+                            }
+                        }
+                    }
+
+                    Plan plan;
+                    plan.offsets    = {0};
+                    plan.nonzeros   = nonzeros;
+                    plan.cache      = 0;
+                    plan.block      = 0;
+
+                    std::vector<Tile> tiles;
+                    std::vector<Block> blocks;
+                    std::vector<cl_uint> maps;
+                    std::vector<cl_uint> slots;
+                    std::vector<std::size_t> seen(nonzeros, 0);
+                    std::vector<cl_ushort> position(nonzeros, 0);
+                    for (std::size_t p = 0; p < submeshes.size(); p++) {
+                        const partition::Submesh& submesh = submeshes[p];
+
+                        Block b;
+                        b.element   = static_cast<cl_uint>(tiles.size());
+                        b.elements  = static_cast<cl_uint>(submesh.elements.size());
+                        b.node      = static_cast<cl_uint>(maps.size());
+                        b.nodes     = static_cast<cl_uint>(submesh.nodes.size());
+                        b.slot      = static_cast<cl_uint>(slots.size());
+                        maps.insert(maps.end(), submesh.nodes.begin(), submesh.nodes.end());
+
+                        // exclusive nonzeros first, then the interface
+                        for (bool interface : {false, true}) {
+                            for (const partition::Index& element : submesh.elements) {
+                                for (std::size_t j = 0; j < entries; j++) {
+                                    cl_uint slot = scatter[entries * element + j];
+                                    if (shared[slot] != interface or seen[slot] == p + 1) { continue; }
+                                    seen[slot]      = p + 1;
+                                    position[slot]  = static_cast<cl_ushort>(std::min(slots.size() - b.slot, capacity - 1));
+                                    slots.push_back(slot);
+                                }
+                            }
+                            if (not interface) { b.exclusive = static_cast<cl_uint>(slots.size() - b.slot); }
+                        }
+                        b.slots = static_cast<cl_uint>(slots.size() - b.slot);
+                        blocks.push_back(b);
+
+                        for (std::size_t i = 0; i < submesh.elements.size(); i++) {
+                            Tile t;
+                            for (std::size_t j = 0; j < 3; j++) { t.nodes[j] = submesh.connectivity[submesh.offsets[i] + j]; }
+                            for (std::size_t j = 0; j < entries; j++) { t.slots[j] = position[scatter[entries * submesh.elements[i] + j]]; }
+                            t.element       = static_cast<cl_uint>(submesh.elements[i]);
+                            t.resistivity   = 1.0;
+                            tiles.push_back(t);
+                        }
+                        plan.offsets.push_back(tiles.size());
+                        plan.cache  = std::max<std::size_t>(plan.cache, b.nodes);
+                        plan.block  = std::max<std::size_t>(plan.block, b.slots);
+                    }
+
+                    // a block over the ushort range or the local memory retries smaller
+                    std::size_t footprint = plan.cache * sizeof(cl_float3) + plan.block * sizeof(float);
+                    if (footprint > local or plan.block > capacity) {
+                        limit = limit * 3 / 4;
+                        continue;
                     }
+
+                    // zero-sized buffers are invalid, an empty subset still gets one record
+                    if (tiles.empty())  { tiles.resize(1); }
+                    if (blocks.empty()) { blocks.resize(1); }
+                    if (maps.empty())   { maps.resize(1); }
+                    if (slots.empty())  { slots.resize(1); }
+
+                    plan.elements   = this->buffer(tiles, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
+                    plan.blocks     = this->buffer(blocks, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
+                    plan.maps       = this->buffer(maps, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
+                    plan.slots      = this->buffer(slots, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR);
+                    plan.values     = this->buffer<float>(plan.nonzeros, CL_MEM_READ_WRITE);
+                    return plan;
                 }
+            }
+
+            Handle<float>
+            tiled(const Plan& plan, const cl::Buffer& areas, const cl::Buffer& conductivity, const Events& events) {
+                const std::size_t partitions = plan.offsets.size() - 1;
+
+                cl::Event fill;
+                queue_.enqueueFillBuffer(plan.values, 0.0f, 0, plan.nonzeros * sizeof(float), &events, &fill);
+                if (partitions == 0) { return {plan.values, plan.nonzeros, fill}; }
+
+                tiled_.setArg(0, nodes_);
+                tiled_.setArg(1, plan.blocks);
+                tiled_.setArg(2, plan.elements);
+                tiled_.setArg(3, plan.maps);
+                tiled_.setArg(4, plan.slots);
+                tiled_.setArg(5, plan.values);
+                tiled_.setArg(6, areas);
+                tiled_.setArg(7, conductivity);
+                tiled_.setArg(8, cl::Local(std::max<std::size_t>(1, plan.cache) * sizeof(cl_float3)));
+                tiled_.setArg(9, cl::Local(std::max<std::size_t>(1, plan.block) * sizeof(float)));
+
+                std::size_t width = std::min<std::size_t>(64, tiled_.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device_));
+
+                Events waits = {fill};
+                cl::Event event;
+                queue_.enqueueNDRangeKernel(tiled_, cl::NullRange, partitions * width, width, &waits, &event);
+                return {plan.values, plan.nonzeros, event};
+            }
+
+            Handle<float>
+            scatter(const cl::Buffer& areas, const cl::Buffer& conductivity, const Events& events) {
+                const Plan& plan        = this->plan();
+                const std::size_t count = plan.offsets.back();
+                if (strategy_ == Strategy::TILED) { return this->tiled(plan, areas, conductivity, events); }
+
+                cl::Kernel& kernel = (strategy_ == Strategy::COLOR)     ? stiffness_
+                                   : (strategy_ == Strategy::ATOMIC)    ? atomic_
+                                   :                                      element_
+                                   ;
+                kernel.setArg(0, static_cast<ulong>(count));
+                kernel.setArg(1, nodes_);
+                kernel.setArg(2, plan.elements);
+                kernel.setArg(3, (strategy_ == Strategy::REDUCE) ? plan.matrices : plan.values);
+                kernel.setArg(4, areas);            // null buffers select the
+                kernel.setArg(5, conductivity);     // in-kernel fallbacks
 
-                return ii;
+                Events waits = events;
+                switch (strategy_) {
+                    case Strategy::COLOR:
+                    {
+                        cl::Event fill;
+                        queue_.enqueueFillBuffer(plan.values, 0.0f, 0, plan.nonzeros * sizeof(float), &waits, &fill);
+                        waits = {fill};
+
+                        // colors are launched back to back on the in-order queue, each
+                        // one over its own range of the color-sorted element buffer
+                        for (std::size_t color = 0; color + 1 < plan.offsets.size(); color++) {
+                            std::size_t offset  = plan.offsets[color];
+                            std::size_t size    = plan.offsets[color + 1] - offset;
+                            if (size == 0) { continue; }
+
+                            cl::Event event;
+                            queue_.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, &waits, &event);
+                            waits = {event};
+                        }
+                        break;
+                    }
+                    case Strategy::ATOMIC:
+                    {
+                        cl::Event fill;
+                        queue_.enqueueFillBuffer(plan.values, 0.0f, 0, plan.nonzeros * sizeof(float), &waits, &fill);
+                        waits = {fill};
+
+                        if (count == 0) { break; }
+                        cl::Event event;
+                        queue_.enqueueNDRangeKernel(kernel, cl::NullRange, count, cl::NullRange, &waits, &event);
+                        waits = {event};
+                        break;
+                    }
+                    case Strategy::REDUCE:
+                    {
+                        if (count != 0) {
+                            cl::Event event;
+                            queue_.enqueueNDRangeKernel(kernel, cl::NullRange, count, cl::NullRange, &waits, &event);
+                            waits = {event};
+                        }
+
+                        if (plan.nonzeros == 0) { break; }
+                        reduce_.setArg(0, static_cast<ulong>(plan.nonzeros));
+                        reduce_.setArg(1, plan.segments);
+                        reduce_.setArg(2, plan.sources);
+                        reduce_.setArg(3, plan.matrices);
+                        reduce_.setArg(4, plan.values);
+
+                        cl::Event event;
+                        queue_.enqueueNDRangeKernel(reduce_, cl::NullRange, plan.nonzeros, cl::NullRange, &waits, &event);
+                        waits = {event};
+                        break;
+                    }
+                    case Strategy::TILED:
+                        break;
+                }
+                if (waits.empty()) {
+                    cl::Event event;
+                    queue_.enqueueMarkerWithWaitList(nullptr, &event);
+                    waits = {event};
+                }
+                return {plan.values, plan.nonzeros, waits.back()};
             }
 
-            cl::Device  device_;
-            cl::Context context_;
-            Memory      memory_;
+            cl::Device          device_;
+            cl::Context         context_;
+            Memory              memory_;
+            cl::CommandQueue    queue_;
 
-            tomos::mesh::Mesh   mesh_;
+            std::shared_ptr<Topology> topology_;
+            partition::Indices  subset_;
+            std::optional<Plan> plan_;
+            std::optional<std::size_t>      tile_;
+            std::optional<sparse::Format>   format_;
+            std::optional<Product>          product_;
             cl::Buffer          nodes_;
             cl::Buffer          elements_;
+            cl::Buffer          conductivity_;
+            std::vector<float>  staging_;
+            cl::Event           staged_;
+
+            Strategy        strategy_ = Strategy::COLOR;
+            sparse::Storage storage_;
 
-            cl::Program program_;
-            cl::Kernel  area_;
-            cl::Kernel  centroid_;
-            cl::Kernel  normal_;
-            cl::Kernel  stiffness_;
+            cl::Program     program_;
+            cache::Status   cache_;
+            cl::Kernel      area_;
+            cl::Kernel      centroid_;
+            cl::Kernel      normal_;
+            cl::Kernel      geometry_;
+            cl::Kernel      stiffness_;
+            cl::Kernel      atomic_;
+            cl::Kernel      element_;
+            cl::Kernel      reduce_;
+            cl::Kernel      tiled_;
+            cl::Kernel      scalar_;
+            cl::Kernel      vector_;
+            cl::Kernel      sell_;
+            cl::Kernel      upper_;
+            cl::Kernel      pack_;
     };
 } // namespace tomos
 
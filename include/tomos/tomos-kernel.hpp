@@ -0,0 +1,34 @@
+#ifndef TOMOS_KERNEL_HPP__
+#define TOMOS_KERNEL_HPP__
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace tomos {
+namespace kernel {
+    // compile-time specialization of shaders/tomos.kernel, every field
+    // becomes a -D build option so the device compiler can fold it
+    struct Options {
+        // TOMOS_NODES, nodes per element; reserved for higher-order elements,
+        // only 3-node triangles are supported for now and build() rejects the rest
+        std::size_t             nodes       = 3;
+        float                   thickness   = 1.0f;     // TOMOS_THICKNESS
+        std::optional<float>    resistivity = 1.0f;     // TOMOS_RESISTIVITY, per-element when empty
+        bool                    symmetric   = false;    // TOMOS_SYMMETRIC, assembles the upper triangle only
+        std::filesystem::path   path        = {};       // loads the kernel from disk instead of the embedded copy
+    };
+
+    // kernel source compiled into the library at build time
+    const std::string&
+    embedded();
+
+    std::string
+    source(const Options& options);
+
+    std::string
+    build(const Options& options);
+} // namespace kernel
+} // namespace tomos
+
+#endif // TOMOS_KERNEL_HPP__
@@ -2,7 +2,9 @@
 #define TOMOS_METIS_HPP__
 
 #include <iostream>
+#include <memory>
 #include <metis.h>
+#include <span>
 #include <tomos/tomos-mesh.hpp>
 
 #include "tomos-partition.hpp"
@@ -20,49 +22,114 @@ namespace metis {
 
     enum class Common : uint8_t { NODE = 1, EDGE = 2, FACE = 3 };
 
-    class Dual {
+    // arrays allocated by METIS are released with METIS_Free
+    struct Free {
+        void
+        operator()(idx_t * pointer) const { METIS_Free(pointer); }
+    };
+    using Buffer = std::unique_ptr<idx_t[], Free>;
+
+    // movable owner of a METIS graph in compressed form, vertex v neighbours
+    // adjncy[xadj[v]] to adjncy[xadj[v + 1] - 1]; the views stay valid
+    // for the lifetime of the graph
+    class Graph {
         public:
-            Dual(const tomos::mesh::Mesh& mesh, Common common)
-                : ne_(static_cast<idx_t>(mesh.elements.size()))
-                , nn_(static_cast<idx_t>(mesh.nodes.size()))
-            {
+            Graph(Graph&&)                  = default;
+            Graph& operator=(Graph&&)       = default;
+
+            Graph(const Graph&)             = delete;
+            Graph& operator=(const Graph&)  = delete;
+
+            // number of vertices
+            std::size_t
+            size() const { return xadj_ ? static_cast<std::size_t>(vertices_) : 0; }
+
+            // METIS xadj, size() + 1 entries
+            std::span<const idx_t>
+            offsets() const {
+                if (not xadj_) { return {}; }
+                return {xadj_.get(), static_cast<std::size_t>(vertices_) + 1};
+            }
+
+            // METIS adjncy, the diagonal is not included
+            std::span<const idx_t>
+            neighbours() const {
+                if (not xadj_) { return {}; }
+                return {adjncy_.get(), static_cast<std::size_t>(xadj_[vertices_])};
+            }
+
+            std::span<const idx_t>
+            neighbours(std::size_t vertex) const {
+                std::size_t first = static_cast<std::size_t>(xadj_[vertex]);
+                std::size_t last  = static_cast<std::size_t>(xadj_[vertex + 1]);
+                return {adjncy_.get() + first, last - first};
+            }
+
+            std::size_t
+            degree(std::size_t vertex) const {
+                return static_cast<std::size_t>(xadj_[vertex + 1] - xadj_[vertex]);
+            }
+
+            // copies the views into a map, one allocation per vertex
+            Adjacency
+            adjacency() const {
+                Adjacency values;
+                for (std::size_t key = 0; key < this->size(); key++) {
+                    std::span<const idx_t> vs = this->neighbours(key);
+                    values[key] = Neighbours(vs.begin(), vs.end());
+                }
+                return values;
+            }
+        protected:
+            Graph() = default;
+
+            // element pointers and indices of a mesh in the METIS layout
+            static std::pair<std::vector<idx_t>, std::vector<idx_t>>
+            elements(const tomos::mesh::Mesh& mesh) {
                 std::vector<idx_t> eptr = {0};
                 std::vector<idx_t> eind = {};
 
+                eptr.reserve(mesh.elements.size() + 1);
                 for (const tomos::mesh::Element& e : mesh.elements) {
                     eptr.push_back(e.nodes.size() + eptr.back());
                     for (const mesh::node::Number& n : e.nodes) { eind.push_back(n); }
                 }
-                idx_t numflag   = 0; // C-style 0-base indexing
-                idx_t ncommon   = static_cast<idx_t>(common);
-
-                METIS_MeshToDual(&ne_, &nn_, eptr.data(), eind.data(), &ncommon, &numflag, &xadj_, &adjncy_);
+                return {std::move(eptr), std::move(eind)};
             }
 
-            ~Dual() {
-                METIS_Free(xadj_);
-                METIS_Free(adjncy_);
+            // takes ownership of the arrays METIS returned
+            void
+            adopt(idx_t vertices, idx_t * xadj, idx_t * adjncy) {
+                vertices_   = vertices;
+                xadj_       = Buffer(xadj);
+                adjncy_     = Buffer(adjncy);
             }
 
-            Adjacency
-            adjacency() const {
-                Adjacency values;
+            idx_t   vertices_   = 0;
+            Buffer  xadj_;          // pointer structure
+            Buffer  adjncy_;        // pointer structure
+    };
 
-                std::size_t keys    = static_cast<std::size_t>(ne_);
-                idx_t * prev        = xadj_;
-                idx_t * next        = xadj_ + 1;
+    // elements sharing at least common nodes are adjacent
+    class Dual : public Graph {
+        public:
+            Dual(const tomos::mesh::Mesh& mesh, Common common)
+                : ne_(static_cast<idx_t>(mesh.elements.size()))
+                , nn_(static_cast<idx_t>(mesh.nodes.size()))
+            {
+                auto [eptr, eind] = Graph::elements(mesh);
 
-                for (std::size_t key = 0; key < keys; key++) {
-                    values[key] = {};
-                    for (idx_t j = *prev; j < *next; j++) { values[key].push_back(adjncy_[j]); }
+                idx_t numflag   = 0; // C-style 0-base indexing
+                idx_t ncommon   = static_cast<idx_t>(common);
 
-                    prev++; next++;
-                }
-                return values;
+                idx_t * xadj    = nullptr;
+                idx_t * adjncy  = nullptr;
+                METIS_MeshToDual(&ne_, &nn_, eptr.data(), eind.data(), &ncommon, &numflag, &xadj, &adjncy);
+                this->adopt(ne_, xadj, adjncy);
             }
 
             Partitions
-            partition(std::size_t count) {
+            partition(std::size_t count) const {
                 Partitions values;
 
                 if (count == 0) {
@@ -79,11 +146,12 @@ namespace metis {
                     idx_t options[METIS_NOPTIONS];
                     METIS_SetDefaultOptions(options);
 
+                    idx_t vertices = ne_;
                     METIS_PartGraphKway(
-                              &ne_          // number of vertices
+                              &vertices     // number of vertices
                             , &ncon         // number of balancing constraints
-                            , xadj_
-                            , adjncy_
+                            , xadj_.get()
+                            , adjncy_.get()
                             , NULL          // vwgt
                             , NULL          // vsize
                             , NULL          // adjwgt
@@ -103,59 +171,112 @@ namespace metis {
                 }
                 return values;
             }
+
+            // weighted, multi-constraint k-way partitioning: compute weights
+            // are the first constraint, node-count weights an optional second
+            partition::Layout
+            partition(const partition::Options& options) const {
+                const std::size_t elements = static_cast<std::size_t>(ne_);
+
+                if (options.count == 0) {
+                    throw std::domain_error("partition count must be greater than 0");
+                }
+                if ((not options.compute.empty() and options.compute.size() != elements)
+                        or (not options.nodes.empty() and options.nodes.size() != elements)) {
+                    throw std::invalid_argument("weights do not match the number of elements");
+                }
+                if (not options.targets.empty() and options.targets.size() != options.count) {
+                    throw std::invalid_argument("targets do not match the number of partitions");
+                }
+
+                std::vector<Partition> part(elements, 0);
+                std::size_t edgecut = 0;
+
+                if (options.count > 1 and elements > 0) {
+                    idx_t ncon      = options.nodes.empty() ? 1 : 2;
+                    idx_t nparts    = static_cast<idx_t>(options.count);
+                    idx_t objval    = 0;
+
+                    std::vector<idx_t> vwgt;
+                    if (not options.compute.empty() or not options.nodes.empty()) {
+                        vwgt.reserve(elements * ncon);
+                        for (std::size_t e = 0; e < elements; e++) {
+                            vwgt.push_back(options.compute.empty() ? 1 : static_cast<idx_t>(options.compute[e]));
+                            if (ncon == 2) { vwgt.push_back(static_cast<idx_t>(options.nodes[e])); }
+                        }
+                    }
+
+                    // METIS wants the fractions of every constraint to sum to one
+                    std::vector<real_t> tpwgts;
+                    if (not options.targets.empty()) {
+                        float share = 0.0f;
+                        for (const float& t : options.targets) { share += t; }
+                        for (const float& t : options.targets) {
+                            for (idx_t c = 0; c < ncon; c++) { tpwgts.push_back(static_cast<real_t>(t / share)); }
+                        }
+                    }
+                    std::vector<real_t> ubvec(ncon, static_cast<real_t>(options.tolerance));
+
+                    std::vector<idx_t> ps(elements);
+                    idx_t metis[METIS_NOPTIONS];
+                    METIS_SetDefaultOptions(metis);
+
+                    idx_t vertices = ne_;
+                    int status = METIS_PartGraphKway(
+                              &vertices                                 // number of vertices
+                            , &ncon                                     // number of balancing constraints
+                            , xadj_.get()
+                            , adjncy_.get()
+                            , vwgt.empty()      ? NULL : vwgt.data()    // vwgt
+                            , NULL                                      // vsize
+                            , NULL                                      // adjwgt
+                            , &nparts                                   // number of partitions
+                            , tpwgts.empty()    ? NULL : tpwgts.data()  // tpwgts
+                            , ubvec.data()                              // ubvec
+                            , metis                                     // options
+                            , &objval                                   // edgecut
+                            , ps.data()
+                            );
+                    if (status != METIS_OK) {
+                        throw std::runtime_error("METIS_PartGraphKway failed");
+                    }
+
+                    std::copy(ps.begin(), ps.end(), part.begin());
+                    edgecut = static_cast<std::size_t>(objval);
+                }
+
+                partition::Layout values = partition::layout(std::move(part), options.count);
+                values.edgecut           = edgecut;
+                values.imbalance.push_back(partition::imbalance(values, options.compute, options.targets));
+                if (not options.nodes.empty()) {
+                    values.imbalance.push_back(partition::imbalance(values, options.nodes, options.targets));
+                }
+                return values;
+            }
         private:
             idx_t ne_;  // number of elements
             idx_t nn_;  // number of nodes
-
-            idx_t * xadj_;      // pointer structure
-            idx_t * adjncy_;    // pointer structure
     };
 
-    class Nodal {
+    // nodes sharing an element are adjacent
+    class Nodal : public Graph {
         public:
             Nodal(const tomos::mesh::Mesh& mesh)
                 : ne_(static_cast<idx_t>(mesh.elements.size()))
                 , nn_(static_cast<idx_t>(mesh.nodes.size()))
             {
-                std::vector<idx_t> eptr = {0};
-                std::vector<idx_t> eind = {};
-
-                for (const tomos::mesh::Element& e : mesh.elements) {
-                    eptr.push_back(e.nodes.size() + eptr.back());
-                    for (const mesh::node::Number& n : e.nodes) { eind.push_back(n); }
-                }
+                auto [eptr, eind] = Graph::elements(mesh);
 
                 idx_t numflag = 0;  // C-style 0-based indexing
-                METIS_MeshToNodal(&ne_, &nn_, eptr.data(), eind.data(), &numflag, &xadj_, &adjncy_);
-            }
-
-            Adjacency
-            adjacency() const {
-                Adjacency values;
-
-                std::size_t keys    = static_cast<std::size_t>(nn_);
-                idx_t * prev        = xadj_;
-                idx_t * next        = xadj_ + 1;
-
-                for (std::size_t key = 0; key < keys; key++) {
-                    values[key] = {};
-                    for (idx_t j = *prev; j < *next; j++) { values[key].push_back(adjncy_[j]); }
 
-                    prev++; next++;
-                }
-                return values;
-            }
-
-            ~Nodal() {
-                METIS_Free(xadj_);
-                METIS_Free(adjncy_);
+                idx_t * xadj    = nullptr;
+                idx_t * adjncy  = nullptr;
+                METIS_MeshToNodal(&ne_, &nn_, eptr.data(), eind.data(), &numflag, &xadj, &adjncy);
+                this->adopt(nn_, xadj, adjncy);
             }
         private:
             idx_t ne_;  // number of elements
             idx_t nn_;  // number of nodes
-
-            idx_t * xadj_;      // pointer structure
-            idx_t * adjncy_;    // pointer structure
     };
 } // namespace metis
 } // namespace tomos
@@ -0,0 +1,98 @@
+#ifndef TOMOS_NATIVE_HPP__
+#define TOMOS_NATIVE_HPP__
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <tomos/tomos-mesh.hpp>
+
+#include "tomos-backend.hpp"
+#include "tomos-kernel.hpp"
+#include "tomos-parallel.hpp"
+#include "tomos-topology.hpp"
+
+namespace tomos {
+    // multithreaded host backend, element kernels are evaluated in batches
+    // of LANES elements laid out so the compiler vectorizes across them
+    class Native : public Backend {
+        public:
+            static constexpr std::size_t LANES = 8;
+
+            // COLOR runs one parallel loop per color class; PARTITION gives every
+            // thread one METIS partition, accumulated privately without barriers,
+            // and sums the interface nonzeros afterwards in partition order so the
+            // result is bitwise reproducible for a fixed thread count
+            enum class Strategy : std::uint8_t { COLOR = 0, PARTITION = 1 };
+
+            // thickness, resistivity and symmetric follow kernel::Options as in
+            // Engine, symmetric selecting UPPER storage; path is ignored
+            explicit Native(
+                      const tomos::mesh::Mesh&      mesh
+                    , std::size_t                   threads = parallel::concurrency()
+                    , const kernel::Options&        options = {}
+                    );
+
+            explicit Native(
+                      std::shared_ptr<Topology>     topology
+                    , std::size_t                   threads = parallel::concurrency()
+                    , const kernel::Options&        options = {}
+                    );
+
+            std::vector<float>
+            area() override;
+
+            std::vector<tomos::mesh::Node>
+            centroid() override;
+
+            std::vector<tomos::mesh::Node>
+            normal() override;
+
+            std::vector<float>
+            color() override;
+
+            std::vector<float>
+            stiffness(std::span<const float> conductivity) override;
+
+            Strategy
+            strategy() const { return strategy_; }
+
+            // switching strategies discards the plan, it is rebuilt by the next assembly
+            void
+            strategy(Strategy strategy);
+        private:
+            // color- or partition-sorted element order with the scatter slots
+            // of each element
+            struct Plan {
+                std::vector<std::uint32_t>  order;
+                std::vector<std::size_t>    offsets;    // color or partition c spans [offsets[c], offsets[c + 1])
+                std::vector<std::uint32_t>  indices;    // value slots per element, in element order
+                std::vector<std::size_t>    entries;    // element matrix entry of every slot
+                std::size_t                 nonzeros;
+
+                // Strategy::PARTITION only, private interface copies follow
+                // the nonzeros in the value array
+                std::vector<std::uint32_t>  targets;    // destination of every slot, in plan order
+                std::size_t                 copies;     // private interface entries
+                std::vector<std::uint32_t>  interface;  // nonzeros shared by partitions
+                std::vector<std::size_t>    segments;   // interface k sums sources [segments[k], segments[k + 1])
+                std::vector<std::uint32_t>  sources;    // private copies, in partition order
+            };
+
+            const Plan&
+            plan();
+
+            void
+            partitioned(Plan& plan);
+
+            std::shared_ptr<Topology>   topology_;
+            const tomos::mesh::Mesh&    mesh_;
+            parallel::Pool              pool_;
+            sparse::Storage             storage_;
+            float                       thickness_;
+            float                       resistivity_;
+            Strategy                    strategy_ = Strategy::COLOR;
+            std::optional<Plan>         plan_;
+    };
+} // namespace tomos
+
+#endif // TOMOS_NATIVE_HPP__
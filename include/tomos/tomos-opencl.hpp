@@ -0,0 +1,8 @@
+#ifndef TOMOS_OPENCL_HPP__
+#define TOMOS_OPENCL_HPP__
+
+#define CL_HPP_TARGET_OPENCL_VERSION 300
+#define CL_HPP_ENABLE_EXCEPTIONS
+#include <CL/opencl.hpp>
+
+#endif // TOMOS_OPENCL_HPP__
@@ -0,0 +1,60 @@
+#ifndef TOMOS_PARALLEL_HPP__
+#define TOMOS_PARALLEL_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tomos {
+namespace parallel {
+    // [first, last) range of a parallel loop handed to a single thread
+    using Body = std::function<void(std::size_t, std::size_t)>;
+
+    std::size_t
+    concurrency();
+
+    // persistent workers sharing chunks of a range, the calling thread
+    // takes part in every loop so a pool of size 1 spawns no thread
+    class Pool {
+        public:
+            explicit Pool(std::size_t threads = concurrency());
+            ~Pool();
+
+            Pool(const Pool&)               = delete;
+            Pool& operator=(const Pool&)    = delete;
+
+            std::size_t
+            size() const;
+
+            void
+            for_each(std::size_t first, std::size_t last, const Body& body, std::size_t grain = 1024);
+        private:
+            void
+            work();
+
+            void
+            run();
+
+            std::vector<std::thread>    workers_;
+            std::mutex                  mutex_;
+            std::condition_variable     wake_;
+            std::condition_variable     done_;
+            std::uint64_t               generation_ = 0;
+            std::size_t                 active_     = 0;
+            bool                        stop_       = false;
+
+            const Body *                body_       = nullptr;
+            std::size_t                 last_       = 0;
+            std::size_t                 grain_      = 1;
+            std::atomic<std::size_t>    next_       = 0;
+            std::exception_ptr          error_      = nullptr;
+    };
+} // namespace parallel
+} // namespace tomos
+
+#endif // TOMOS_PARALLEL_HPP__
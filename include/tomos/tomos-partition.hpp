@@ -7,7 +7,11 @@
 #include <tomos/tomos-mesh.hpp>
 #include <vector>
 
+#include "tomos-parallel.hpp"
+
 namespace tomos {
+namespace metis { class Dual; }
+
 namespace partition {
     using Index         = std::size_t;
     using Indices       = std::vector<Index>;
@@ -15,11 +19,100 @@ namespace partition {
     using Partition     = std::size_t;
     using Partitions    = std::map<Partition, Indices>;
 
+    // weighted k-way request, empty weights count as one per element and
+    // empty targets split the total evenly
+    struct Options {
+        std::size_t                 count       = 1;        // number of partitions
+        std::vector<std::size_t>    compute     = {};       // assembly cost per element
+        std::vector<std::size_t>    nodes       = {};       // node-count weight per element, a second constraint
+        std::vector<float>          targets     = {};       // share of every partition, e.g. relative device speed
+        float                       tolerance   = 1.03f;    // allowed load over target, per constraint
+    };
+
+    // flat partitioning, partition p owns elements[offsets[p]] to
+    // elements[offsets[p + 1] - 1] in ascending order
+    struct Layout {
+        std::vector<Partition>      part;                   // partition of every element
+        std::vector<std::size_t>    offsets;                // count + 1
+        Indices                     elements;
+        std::size_t                 edgecut     = 0;        // dual edges between partitions
+        std::vector<float>          imbalance   = {};       // per constraint, max over partitions of load / target
+
+        Partitions
+        partitions() const;
+    };
+
+    // groups part by partition, edgecut and imbalance are left to the caller
+    Layout
+    layout(std::vector<Partition> part, std::size_t count);
+
+    // largest load / target over the partitions of a layout for one
+    // constraint, empty weights count as one and empty targets as 1 / count
+    float
+    imbalance(const Layout& layout, const std::vector<std::size_t>& weights, const std::vector<float>& targets);
+
+    // node counts of every partition, in partition (map) order
+    struct Statistics {
+        std::vector<std::size_t>    nodes;              // unique nodes
+        std::vector<std::size_t>    halo;               // nodes shared with another partition
+        std::size_t                 maximum = 0;        // largest entry of nodes
+    };
+
+    // epoch-stamped marker arrays instead of per-partition sets, one per
+    // worker of pool; partitions are counted in parallel
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Layout& layout, parallel::Pool& pool);
+
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Layout& layout, std::size_t threads = parallel::concurrency());
+
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Partitions& ps, parallel::Pool& pool);
+
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Partitions& ps, std::size_t threads = parallel::concurrency());
+
     bool
     valid(const tomos::mesh::Mesh& mesh, const Partitions& ps, std::size_t limit);
 
+    // smallest k-way partition count keeping every partition within limit
+    // nodes; starts from the nodes / limit lower bound and probes one count
+    // per thread every round, every count is partitioned at most once; METIS
+    // runs serially, the node counts of each layout on threads
     std::size_t
-    optimal(const tomos::mesh::Mesh& mesh, std::size_t limit);
+    optimal(const tomos::mesh::Mesh& mesh, std::size_t limit, std::size_t threads = parallel::concurrency());
+
+    // same search over an existing EDGE dual of mesh
+    std::size_t
+    optimal(const metis::Dual& dual, const tomos::mesh::Mesh& mesh, std::size_t limit, std::size_t threads = parallel::concurrency());
+
+    // recursive bisection of the EDGE dual, only partitions above limit
+    // nodes are split again; partitions may differ in size
+    Layout
+    bisection(const metis::Dual& dual, const tomos::mesh::Mesh& mesh, std::size_t limit);
+
+    // node number within a submesh, sized for local memory tiles
+    using Local = std::uint16_t;
+
+    // one partition with compact node numbers; interior nodes come first,
+    // followed by the halo, each in order of first appearance
+    struct Submesh {
+        Indices                                 elements;       // global element numbers
+        std::vector<tomos::mesh::node::Number>  nodes;          // local to global
+        std::vector<Local>                      connectivity;   // local nodes, element by element
+        std::vector<std::size_t>                offsets;        // element i spans [offsets[i], offsets[i + 1])
+        std::size_t                             interior = 0;   // nodes in no other partition
+
+        std::size_t
+        halo() const { return nodes.size() - interior; }
+    };
+
+    // throws std::overflow_error when a partition has more nodes than Local holds
+    std::vector<Submesh>
+    submeshes(const tomos::mesh::Mesh& mesh, const Layout& layout, parallel::Pool& pool);
+
+    std::vector<Submesh>
+    submeshes(const tomos::mesh::Mesh& mesh, const Layout& layout, std::size_t threads = parallel::concurrency());
 } // namespace partition
 } // namespace tomos
 
@@ -0,0 +1,103 @@
+#ifndef TOMOS_REORDER_HPP__
+#define TOMOS_REORDER_HPP__
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <tomos/tomos-mesh.hpp>
+#include <vector>
+
+#include "tomos-metis.hpp"
+
+namespace tomos {
+namespace reorder {
+    using Index         = std::uint32_t;
+    using Permutation   = std::vector<Index>;
+
+    enum class Nodes : uint8_t { NONE = 0, RCM = 1, NESTED = 2 };
+    enum class Elements : uint8_t { NONE = 0, MORTON = 1, HILBERT = 2, PARTITION = 3 };
+
+    // order[new] is the original index at a new position, rank[old] its new
+    // position; METIS calls them perm and iperm
+    struct Ordering {
+        Permutation order;
+        Permutation rank;
+    };
+
+    struct Options {
+        Nodes       nodes       = Nodes::RCM;
+        Elements    elements    = Elements::HILBERT;
+        std::size_t parts       = 1;    // EDGE dual partitions for Elements::PARTITION
+    };
+
+    // renumbered mesh with the orderings needed to go back to the input numbering
+    struct Reordered {
+        tomos::mesh::Mesh   mesh;
+        Ordering            nodes;
+        Ordering            elements;
+    };
+
+    Ordering
+    identity(std::size_t count);
+
+    // ordering from order alone, throws std::invalid_argument if it is not a permutation
+    Ordering
+    ordering(Permutation order);
+
+    // reverse Cuthill-McKee, each connected component from a pseudo-peripheral node
+    Ordering
+    rcm(const metis::Nodal& nodal);
+
+    // METIS_NodeND fill-reducing nested dissection
+    Ordering
+    nested(const metis::Nodal& nodal);
+
+    // element centroids along a Z-order or Hilbert curve over the bounding
+    // box of the x-y plane, z is ignored
+    Ordering
+    morton(const tomos::mesh::Mesh& mesh);
+
+    Ordering
+    hilbert(const tomos::mesh::Mesh& mesh);
+
+    // elements grouped by partition, original order kept within one
+    Ordering
+    partitioned(const metis::Partitions& partitions, std::size_t elements);
+
+    Reordered
+    apply(const tomos::mesh::Mesh& mesh, const Ordering& nodes, const Ordering& elements);
+
+    Reordered
+    build(const tomos::mesh::Mesh& mesh, const Options& options = {});
+
+    // largest |i - j| over the node pairs of every element
+    std::size_t
+    bandwidth(const tomos::mesh::Mesh& mesh);
+
+    // values in the original numbering to the new one and back, e.g. a
+    // per-element conductivity in and per-element areas or nodal values out
+    template <typename T>
+    std::vector<T>
+    permute(const Ordering& ordering, std::span<const T> values) {
+        if (values.size() != ordering.order.size()) {
+            throw std::length_error("values do not match the ordering");
+        }
+        std::vector<T> xs(values.size());
+        for (std::size_t i = 0; i < xs.size(); i++) { xs[i] = values[ordering.order[i]]; }
+        return xs;
+    }
+
+    template <typename T>
+    std::vector<T>
+    restore(const Ordering& ordering, std::span<const T> values) {
+        if (values.size() != ordering.order.size()) {
+            throw std::length_error("values do not match the ordering");
+        }
+        std::vector<T> xs(values.size());
+        for (std::size_t i = 0; i < xs.size(); i++) { xs[ordering.order[i]] = values[i]; }
+        return xs;
+    }
+} // namespace reorder
+} // namespace tomos
+
+#endif // TOMOS_REORDER_HPP__
@@ -2,6 +2,11 @@
 #define TOMOS_SPARSE_HPP__
 
 #include "tomos-metis.hpp"
+#include "tomos-parallel.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <span>
 
 namespace tomos {
 namespace sparse {
@@ -9,12 +14,123 @@ namespace sparse {
     using Indices       = std::vector<Index>;
     using Coordinate    = std::pair<Index, Index>;
 
+    // the stiffness matrix is symmetric, UPPER keeps the diagonal and the
+    // entries above it only
+    enum class Storage : uint8_t { FULL = 0, UPPER = 1 };
+
+    // compressed sparse rows with sorted columns, diagonal included
+    template <typename I>
+    struct Pattern {
+        std::vector<I> rows;    // nodes + 1 offsets into cols
+        std::vector<I> cols;
+        Storage storage = Storage::FULL;
+    };
+
+    // matrix entries stored per element of n nodes, n * n or n * (n + 1) / 2
+    std::size_t
+    entries(std::size_t nodes, Storage storage);
+
     std::size_t
-    nonzeros(const metis::Nodal& nodal);
+    nonzeros(const metis::Nodal& nodal, Storage storage = Storage::FULL);
+
+    // O(nnz) construction straight from the METIS buffers; rows and cols must
+    // already hold nodes + 1 and nonzeros entries, e.g. pinned host memory
+    template <typename I>
+    void
+    csr(const metis::Nodal& nodal, std::span<I> rows, std::span<I> cols, Storage storage = Storage::FULL);
+
+    template <typename I>
+    Pattern<I>
+    pattern(const metis::Nodal& nodal, Storage storage = Storage::FULL);
+
+    // value slot of every node pair of every element, element e with n nodes
+    // owns entries(n, storage) consecutive slots: pair (i, j) in row-major
+    // order for FULL, pairs with i <= j row by row for UPPER; the pattern
+    // must come from the same mesh
+    template <typename I>
+    std::vector<I>
+    scatter(const tomos::mesh::Mesh& mesh, const Pattern<I>& pattern, parallel::Pool& pool);
+
+    template <typename I>
+    std::vector<I>
+    scatter(const tomos::mesh::Mesh& mesh, const Pattern<I>& pattern);
+
+    // y = A x over either storage, the upper triangle is mirrored on the fly
+    template <typename I>
+    void
+    multiply(
+              const Pattern<I>&         pattern
+            , std::span<const float>    values
+            , std::span<const float>    x
+            , std::span<float>          y
+            );
+
+    // row lengths of a pattern, they pick the SpMV format
+    struct Lengths {
+        double          mean        = 0.0;
+        double          deviation   = 0.0;
+        std::size_t     maximum     = 0;
+    };
+
+    template <typename I>
+    Lengths
+    lengths(const Pattern<I>& pattern);
+
+    // sliced ELLPACK (SELL-C-sigma) over a FULL pattern: slices of chunk rows
+    // stored column-major, so neighbouring work-items read neighbouring
+    // entries, and rows sorted by decreasing length within windows of sigma
+    // rows to cut the padding; values are moved into the sliced layout by
+    // pack once per assembly
+    template <typename I>
+    struct Sell {
+        static constexpr I PADDING = std::numeric_limits<I>::max();
+
+        std::size_t     chunk       = 0;
+        std::size_t     sigma       = 0;
+        std::size_t     nonzeros    = 0;
+        std::vector<I>  rows;       // row of every slot, slice s holds slots [s * chunk, (s + 1) * chunk)
+        std::vector<I>  slices;     // slice s starts at entry slices[s], slices + 1
+        std::vector<I>  widths;     // longest row of every slice
+        std::vector<I>  cols;       // column of every entry, 0 for padding
+        std::vector<I>  sources;    // CSR value of every entry, PADDING for none, used by pack
+
+        // stored entries per nonzero, 1 without padding
+        double
+        fill() const;
+    };
+
+    template <typename I>
+    Sell<I>
+    sell(const Pattern<I>& pattern, std::size_t chunk = 32, std::size_t sigma = 256);
+
+    // CSR-ordered values in the sliced layout, zero for padding
+    template <typename I>
+    std::vector<float>
+    pack(const Sell<I>& sell, std::span<const float> values);
+
+    // y = A x with values in the sliced layout of pack
+    template <typename I>
+    void
+    multiply(
+              const Sell<I>&            sell
+            , std::span<const float>    values
+            , std::span<const float>    x
+            , std::span<float>          y
+            );
+
+    // SCALAR runs one work-item per row, VECTOR one warp per row, SELL one
+    // work-item per slot of the sliced layout
+    enum class Format : uint8_t { SCALAR = 0, VECTOR = 1, SELL = 2 };
+
+    // VECTOR once rows fill half a warp, otherwise SELL while its padding
+    // stays small and SCALAR beyond that
+    Format
+    select(const Lengths& lengths, double fill, std::size_t warp = 32);
 
     std::pair<Indices, Indices>
     csr(const metis::Nodal& nodal);
 
+    // (row, column) to value slot, in the sorted layout of pattern
     std::map<Coordinate, Index>
     coo(const metis::Nodal& nodal);
 } // namespace sparse
@@ -0,0 +1,69 @@
+#ifndef TOMOS_TOPOLOGY_HPP__
+#define TOMOS_TOPOLOGY_HPP__
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tomos/tomos-mesh.hpp>
+#include <vector>
+
+#include "tomos-color.hpp"
+#include "tomos-metis.hpp"
+#include "tomos-sparse.hpp"
+
+namespace tomos {
+    // graphs and patterns derived from one mesh, each computed on first use
+    // and cached so every subsystem sharing the topology pays for it once;
+    // not synchronized, share it between threads only once it is warm
+    class Topology {
+        public:
+            using Index     = std::uint32_t;
+            using Pattern   = sparse::Pattern<Index>;
+
+            explicit Topology(const tomos::mesh::Mesh& mesh);
+
+            Topology(const Topology&)               = delete;
+            Topology& operator=(const Topology&)    = delete;
+
+            const tomos::mesh::Mesh&
+            mesh() const { return mesh_; }
+
+            const metis::Nodal&
+            nodal();
+
+            metis::Dual&
+            dual(metis::Common common);
+
+            // sorted CSR of the nodal graph, diagonal included
+            const Pattern&
+            pattern(sparse::Storage storage = sparse::Storage::FULL);
+
+            // value slots of every element, see sparse::scatter
+            const std::vector<Index>&
+            scatter(sparse::Storage storage = sparse::Storage::FULL);
+
+            // see color::build
+            const color::Colors&
+            colors(metis::Common common);
+
+            // METIS k-way partitions of the EDGE dual
+            const metis::Partitions&
+            partitions(std::size_t count);
+
+            // see partition::optimal
+            std::size_t
+            optimal(std::size_t limit);
+        private:
+            tomos::mesh::Mesh                                       mesh_;
+            std::optional<metis::Nodal>                             nodal_;
+            std::map<metis::Common, metis::Dual>                    duals_;
+            std::map<sparse::Storage, Pattern>                      patterns_;
+            std::map<sparse::Storage, std::vector<Index>>           scatters_;
+            std::map<metis::Common, color::Colors>                  colors_;
+            std::map<std::size_t, metis::Partitions>                partitions_;
+            std::map<std::size_t, std::size_t>                      optimal_;
+    };
+} // namespace tomos
+
+#endif // TOMOS_TOPOLOGY_HPP__
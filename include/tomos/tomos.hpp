@@ -1,9 +1,18 @@
 #ifndef TOMOS_HPP__
 #define TOMOS_HPP__
 
+#include "tomos-backend.hpp"
+#include "tomos-cache.hpp"
+#include "tomos-cluster.hpp"
 #include "tomos-color.hpp"
+#include "tomos-device.hpp"
 #include "tomos-engine.hpp"
+#include "tomos-kernel.hpp"
 #include "tomos-metis.hpp"
+#include "tomos-native.hpp"
+#include "tomos-parallel.hpp"
+#include "tomos-reorder.hpp"
 #include "tomos-sparse.hpp"
+#include "tomos-topology.hpp"
 
 #endif // TOMOS_HPP__
@@ -0,0 +1,106 @@
+#include "tomos/tomos-cache.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <random>
+
+namespace tomos {
+namespace cache {
+    namespace {
+        // one file per key, named by its hexadecimal value
+        std::filesystem::path
+        filename(const std::filesystem::path& directory, Key key) {
+            std::stringstream ss;
+            ss << std::hex << key << ".bin";
+            return directory / ss.str();
+        }
+    } // namespace
+
+    std::ostream&
+    operator<<(std::ostream& os, Status status) {
+        switch (status) {
+            case Status::DISABLED   : os << "disabled"; break;
+            case Status::HIT        : os << "hit";      break;
+            case Status::MISS       : os << "miss";     break;
+        }
+        return os;
+    }
+
+    Key
+    hash(const std::vector<std::string>& parts) {
+        const Key OFFSET    = 14695981039346656037ULL;
+        const Key PRIME     = 1099511628211ULL;
+
+        Key value = OFFSET;
+        for (const std::string& part : parts) {
+            for (unsigned char c : part) { value = (value ^ c) * PRIME; }
+            // separator, so that {"ab", "c"} and {"a", "bc"} differ
+            value = (value ^ 0xff) * PRIME;
+        }
+        return value;
+    }
+
+    std::filesystem::path
+    directory() {
+        if (const char * value = std::getenv("TOMOS_CACHE")) {
+            return {value};
+        } else if (const char * value = std::getenv("XDG_CACHE_HOME")) {
+            return std::filesystem::path{value} / "tomos";
+        } else if (const char * value = std::getenv("HOME")) {
+            return std::filesystem::path{value} / ".cache" / "tomos";
+        }
+        return {};
+    }
+
+    std::optional<Binary>
+    load(const std::filesystem::path& directory, Key key) {
+        if (directory.empty()) { return std::nullopt; }
+
+        std::ifstream handle(filename(directory, key), std::ios::binary);
+        if (not handle.is_open()) { return std::nullopt; }
+
+        Key stored          = 0;
+        std::uint64_t size  = 0;
+        handle.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+        handle.read(reinterpret_cast<char*>(&size), sizeof(size));
+        if (not handle or stored != key or size == 0) { return std::nullopt; }
+
+        Binary binary(size);
+        handle.read(reinterpret_cast<char*>(binary.data()), static_cast<std::streamsize>(size));
+        if (static_cast<std::uint64_t>(handle.gcount()) != size) { return std::nullopt; }
+
+        return binary;
+    }
+
+    void
+    store(const std::filesystem::path& directory, Key key, const Binary& binary) {
+        if (directory.empty() or binary.empty()) { return; }
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) { return; }
+
+        // write aside and rename, concurrent processes never observe a partial binary
+        std::filesystem::path target    = filename(directory, key);
+        std::filesystem::path temporary = target;
+        temporary += "." + std::to_string(std::random_device{}()) + ".tmp";
+        {
+            std::ofstream handle(temporary, std::ios::binary | std::ios::trunc);
+            if (not handle.is_open()) { return; }
+
+            std::uint64_t size = binary.size();
+            handle.write(reinterpret_cast<const char*>(&key), sizeof(key));
+            handle.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            handle.write(reinterpret_cast<const char*>(binary.data()), static_cast<std::streamsize>(size));
+            if (not handle) {
+                handle.close();
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+        }
+        std::filesystem::rename(temporary, target, error);
+        if (error) { std::filesystem::remove(temporary, error); }
+    }
+} // namespace cache
+} // namespace tomos
@@ -1,42 +1,277 @@
 #include "tomos/tomos-color.hpp"
 
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/edge_coloring.hpp>
-#include <boost/graph/properties.hpp>
-#include <boost/graph/sequential_vertex_coloring.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <numeric>
 
 #include "tomos/tomos-metis.hpp"
 
 namespace tomos {
 namespace color {
+    namespace {
+        const Color         NONE    = std::numeric_limits<Color>::max();
+        const std::size_t   GRAIN   = 1024;
+
+        // splitmix64 finalizer, a fixed pseudo-random priority per vertex
+        std::uint64_t
+        priority(std::uint64_t v) {
+            v += 0x9e3779b97f4a7c15ull;
+            v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+            v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+            return v ^ (v >> 31);
+        }
+
+        // ties broken by the vertex number so the order is total
+        bool
+        before(std::size_t u, std::size_t v, const std::vector<std::uint64_t>& weights) {
+            return (weights[u] != weights[v]) ? (weights[u] > weights[v]) : (u < v);
+        }
+
+        // smallest color no neighbour of v uses, forbidden[c] == v + 1 marks them
+        Color
+        smallest(const tomos::metis::Dual& dual, std::size_t v, const std::vector<Color>& cs, std::vector<std::size_t>& forbidden) {
+            for (const idx_t& u : dual.neighbours(v)) {
+                Color c = cs[u];
+                if (c != NONE and c < forbidden.size()) { forbidden[c] = v + 1; }
+            }
+            Color c = 0;
+            while (c < forbidden.size() and forbidden[c] == v + 1) { c++; }
+            return c;
+        }
+
+        // moves vertices out of classes above the mean into the first smaller
+        // class none of their neighbours use; sequential, so deterministic
+        void
+        balance(const tomos::metis::Dual& dual, std::vector<Color>& cs, std::size_t count, std::size_t degree) {
+            std::vector<std::size_t> sizes(count, 0);
+            for (const Color& c : cs) { sizes[c]++; }
+            const std::size_t target = (cs.size() + count - 1) / count;
+
+            std::vector<std::size_t> forbidden(degree + 1, 0);
+            for (std::size_t v = 0; v < cs.size(); v++) {
+                if (sizes[cs[v]] <= target) { continue; }
+
+                for (const idx_t& u : dual.neighbours(v)) { forbidden[cs[u]] = v + 1; }
+                for (Color c = 0; c < count; c++) {
+                    if (sizes[c] < target and forbidden[c] != v + 1) {
+                        sizes[cs[v]]--;
+                        sizes[c]++;
+                        cs[v] = c;
+                        break;
+                    }
+                }
+            }
+        }
+    } // namespace
+
+    std::size_t
+    Colors::smallest() const {
+        std::size_t value = count() == 0 ? 0 : size(0);
+        for (Color c = 1; c < count(); c++) { value = std::min(value, size(c)); }
+        return value;
+    }
+
+    std::size_t
+    Colors::largest() const {
+        std::size_t value = 0;
+        for (Color c = 0; c < count(); c++) { value = std::max(value, size(c)); }
+        return value;
+    }
+
+    Colors
+    classes(std::vector<Color> color) {
+        Colors values;
+        std::size_t count = color.empty() ? 0 : *std::max_element(color.begin(), color.end()) + 1;
+
+        values.offsets.assign(count + 1, 0);
+        for (const Color& c : color) { values.offsets[c + 1]++; }
+        std::partial_sum(values.offsets.begin(), values.offsets.end(), values.offsets.begin());
+
+        values.order.resize(color.size());
+        std::vector<std::size_t> cursor(values.offsets.begin(), values.offsets.end() - 1);
+        for (std::size_t e = 0; e < color.size(); e++) {
+            values.order[cursor[color[e]]++] = static_cast<std::uint32_t>(e);
+        }
+        values.color = std::move(color);
+        return values;
+    }
+
     Colors
-    build(const tomos::mesh::Mesh& mesh, tomos::metis::Common common) {
-        tomos::metis::Adjacency adjacency = metis::Dual(mesh, common).adjacency();
-
-        typedef std::pair<std::size_t, std::size_t> Edge;
-        std::vector<Edge> edges = {};
-        for (const auto& [k, vs] : adjacency) {
-            for (const tomos::metis::Index& v : vs) {
-                std::size_t fst = std::min(k, v);
-                std::size_t snd = std::max(k, v);
-                edges.emplace_back(fst, snd);
+    build(const tomos::metis::Dual& dual, const Options& options) {
+        const std::size_t n = dual.size();
+
+        std::size_t degree = 0;
+        for (std::size_t v = 0; v < n; v++) { degree = std::max(degree, dual.degree(v)); }
+
+        std::vector<std::uint64_t> weights(n);
+        for (std::size_t v = 0; v < n; v++) { weights[v] = priority(v); }
+
+        std::vector<Color> cs(n, NONE);
+        std::vector<std::size_t> pending(n);
+        for (std::size_t v = 0; v < n; v++) { pending[v] = v; }
+        std::vector<char> selected(n, 0);
+
+        parallel::Pool pool(std::max<std::size_t>(1, options.threads));
+        while (not pending.empty()) {
+            // local maxima among the uncolored vertices form an independent set
+            pool.for_each(0, pending.size(), [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; i++) {
+                    std::size_t v = pending[i];
+                    bool maximum = true;
+                    for (const idx_t& u : dual.neighbours(v)) {
+                        if (cs[u] == NONE and before(u, v, weights)) { maximum = false; break; }
+                    }
+                    selected[v] = maximum;
+                }
+            }, GRAIN);
+
+            // selected vertices are never adjacent, so none reads a color written here
+            pool.for_each(0, pending.size(), [&](std::size_t first, std::size_t last) {
+                std::vector<std::size_t> forbidden(degree + 1, 0);
+                for (std::size_t i = first; i < last; i++) {
+                    std::size_t v = pending[i];
+                    if (selected[v]) { cs[v] = smallest(dual, v, cs, forbidden); }
+                }
+            }, GRAIN);
+
+            std::erase_if(pending, [&](std::size_t v) { return cs[v] != NONE; });
+        }
+
+        std::size_t count = cs.empty() ? 0 : *std::max_element(cs.begin(), cs.end()) + 1;
+        if (options.balance and count > 1) { balance(dual, cs, count, degree); }
+
+        return classes(std::move(cs));
+    }
+
+    Colors
+    incidence(const tomos::mesh::Mesh& mesh, const Options& options) {
+        using Word = std::uint64_t;
+        const std::size_t BITS = 64;
+        const std::size_t n = mesh.elements.size();
+
+        // node to element incidence, every element once per node it has;
+        // far smaller than the NODE dual, which holds every element pair
+        std::vector<std::size_t> offsets(mesh.nodes.size() + 1, 0);
+        for (const tomos::mesh::Element& element : mesh.elements) {
+            for (const tomos::mesh::node::Number& node : element.nodes) { offsets[node + 1]++; }
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<std::uint32_t> touching(offsets.back());
+        std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (std::size_t e = 0; e < n; e++) {
+            for (const tomos::mesh::node::Number& node : mesh.elements[e].nodes) {
+                touching[cursor[node]++] = static_cast<std::uint32_t>(e);
             }
         }
-        std::sort(edges.begin(), edges.end());
-        std::vector<Edge>::iterator it = std::unique(edges.begin(), edges.end());
-        edges.resize(std::distance(edges.begin(), it));
 
-        typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> Graph;
+        // an element has fewer neighbours than incidences over its nodes,
+        // so the masks are sized once for the largest color it may need
+        std::size_t degree = 0;
+        for (const tomos::mesh::Element& element : mesh.elements) {
+            std::size_t d = 0;
+            for (const tomos::mesh::node::Number& node : element.nodes) { d += offsets[node + 1] - offsets[node]; }
+            degree = std::max(degree, d);
+        }
+        const std::size_t words = degree / BITS + 1;
+
+        // colors of the elements of every node; a valid coloring gives each
+        // color of a node to exactly one of its elements
+        std::vector<Word> masks(mesh.nodes.size() * words, 0);
+        auto gather = [&](const tomos::mesh::Element& element, std::vector<Word>& used) {
+            std::fill(used.begin(), used.end(), 0);
+            for (const tomos::mesh::node::Number& node : element.nodes) {
+                for (std::size_t w = 0; w < words; w++) { used[w] |= masks[node * words + w]; }
+            }
+        };
+        auto flip = [&](const tomos::mesh::Element& element, Color c) {
+            for (const tomos::mesh::node::Number& node : element.nodes) {
+                masks[node * words + c / BITS] ^= Word{1} << (c % BITS);
+            }
+        };
 
-        Graph graph(edges.begin(), edges.end(), adjacency.size());
-        std::vector<std::size_t> cs(boost::num_vertices(graph));
+        std::vector<std::uint64_t> weights(n);
+        for (std::size_t e = 0; e < n; e++) { weights[e] = priority(e); }
 
-        boost::iterator_property_map color(&cs.front(), boost::get(boost::vertex_index, graph));
-        boost::sequential_vertex_coloring(graph, color);
+        std::vector<Color> cs(n, NONE);
+        std::vector<std::size_t> pending(n);
+        for (std::size_t e = 0; e < n; e++) { pending[e] = e; }
+        std::vector<char> selected(n, 0);
 
-        Colors colors;
-        for (std::size_t i = 0; i < cs.size(); i++) { colors[i] = cs[i]; }
-        return colors;
+        // Jones-Plassmann as on the dual, neighbours are walked through the nodes
+        parallel::Pool pool(std::max<std::size_t>(1, options.threads));
+        while (not pending.empty()) {
+            pool.for_each(0, pending.size(), [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; i++) {
+                    std::size_t e = pending[i];
+                    bool maximum = true;
+                    for (const tomos::mesh::node::Number& node : mesh.elements[e].nodes) {
+                        for (std::size_t k = offsets[node]; maximum and k < offsets[node + 1]; k++) {
+                            std::size_t f = touching[k];
+                            if (f != e and cs[f] == NONE and before(f, e, weights)) { maximum = false; }
+                        }
+                    }
+                    selected[e] = maximum;
+                }
+            }, GRAIN);
+
+            // selected elements share no node, so each one alone reads and
+            // writes the masks of its nodes
+            pool.for_each(0, pending.size(), [&](std::size_t first, std::size_t last) {
+                std::vector<Word> used(words);
+                for (std::size_t i = first; i < last; i++) {
+                    std::size_t e = pending[i];
+                    if (not selected[e]) { continue; }
+
+                    const tomos::mesh::Element& element = mesh.elements[e];
+                    gather(element, used);
+                    std::size_t w = 0;
+                    while (used[w] == ~Word{0}) { w++; }
+
+                    Color c = w * BITS + static_cast<Color>(std::countr_one(used[w]));
+                    flip(element, c);
+                    cs[e] = c;
+                }
+            }, GRAIN);
+
+            std::erase_if(pending, [&](std::size_t e) { return cs[e] != NONE; });
+        }
+        std::size_t count = cs.empty() ? 0 : *std::max_element(cs.begin(), cs.end()) + 1;
+
+        // same balancing as on the dual, moving an element clears its old
+        // color from the masks of its nodes
+        if (options.balance and count > 1) {
+            std::vector<std::size_t> sizes(count, 0);
+            for (const Color& c : cs) { sizes[c]++; }
+            const std::size_t target = (cs.size() + count - 1) / count;
+
+            std::vector<Word> used(words);
+            for (std::size_t e = 0; e < cs.size(); e++) {
+                if (sizes[cs[e]] <= target) { continue; }
+
+                const tomos::mesh::Element& element = mesh.elements[e];
+                gather(element, used);
+                for (Color c = 0; c < count; c++) {
+                    if (sizes[c] < target and not (used[c / BITS] >> (c % BITS) & 1)) {
+                        flip(element, cs[e]);
+                        flip(element, c);
+                        sizes[cs[e]]--;
+                        sizes[c]++;
+                        cs[e] = c;
+                        break;
+                    }
+                }
+            }
+        }
+        return classes(std::move(cs));
+    }
+
+    Colors
+    build(const tomos::mesh::Mesh& mesh, tomos::metis::Common common, const Options& options) {
+        if (common == tomos::metis::Common::NODE) { return incidence(mesh, options); }
+        return build(metis::Dual(mesh, common), options);
     }
 } // namespace color
 } // namespace tomos
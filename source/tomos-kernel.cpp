@@ -0,0 +1,42 @@
+#include "tomos/tomos-kernel.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace tomos {
+namespace kernel {
+    std::string
+    source(const Options& options) {
+        if (options.path.empty()) { return embedded(); }
+
+        std::ifstream handle(options.path);
+        if (not handle.is_open()) {
+            throw std::runtime_error("could not load OpenCL kernel");
+        }
+
+        std::stringstream ss;
+        ss << handle.rdbuf();
+
+        return ss.str();
+    }
+
+    std::string
+    build(const Options& options) {
+        if (options.nodes != 3) {
+            throw std::domain_error("only three-node triangular elements are supported");
+        }
+
+        // hexadecimal literals keep the host value exact on the device
+        std::stringstream ss;
+        ss << std::hexfloat;
+        ss << "-DTOMOS_NODES=" << options.nodes;
+        ss << " -DTOMOS_THICKNESS=" << options.thickness << "f";
+        if (options.resistivity) {
+            ss << " -DTOMOS_RESISTIVITY=" << *options.resistivity << "f";
+        }
+        if (options.symmetric) { ss << " -DTOMOS_SYMMETRIC"; }
+        return ss.str();
+    }
+} // namespace kernel
+} // namespace tomos
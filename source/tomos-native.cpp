@@ -0,0 +1,362 @@
+#include "tomos/tomos-native.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "tomos/tomos-color.hpp"
+#include "tomos/tomos-sparse.hpp"
+
+namespace tomos {
+    namespace {
+        const std::size_t LANES     = Native::LANES;
+        const std::size_t NODES     = 3;
+        const std::size_t ENTRIES   = NODES * NODES;
+        const std::size_t GRAIN     = 256;
+
+        // structure-of-arrays view of up to LANES triangles, unused lanes
+        // repeat the first element so every lane stays well defined
+        struct Batch {
+            float x[NODES][LANES];
+            float y[NODES][LANES];
+            float z[NODES][LANES];
+            float sigma[LANES];
+            float area[LANES];
+            float ks[ENTRIES][LANES];
+            std::size_t size;
+        };
+
+        // coordinates of element e into lane l
+        void
+        load(const tomos::mesh::Mesh& mesh, std::size_t e, std::size_t l, Batch& batch) {
+            const tomos::mesh::Element& element = mesh.elements[e];
+            for (std::size_t n = 0; n < NODES; n++) {
+                const tomos::mesh::Node& node = mesh.nodes[element.nodes[n]];
+                batch.x[n][l] = node.s[0];
+                batch.y[n][l] = node.s[1];
+                batch.z[n][l] = node.s[2];
+            }
+        }
+
+        // without conductivity every element gets 1 / resistivity, as in
+        // matrix3 of shaders/tomos.kernel
+        template <typename Index>
+        void
+        gather(
+                  const tomos::mesh::Mesh&  mesh
+                , const Index *             elements
+                , std::size_t               count
+                , std::span<const float>    conductivity
+                , float                     resistivity
+                , Batch&                    batch
+              )
+        {
+            batch.size = count;
+            for (std::size_t l = 0; l < LANES; l++) {
+                std::size_t e = static_cast<std::size_t>(elements[(l < count) ? l : 0]);
+                load(mesh, e, l, batch);
+                batch.sigma[l] = conductivity.empty() ? 1.0f / resistivity : conductivity[e];
+            }
+        }
+
+        void
+        areas(Batch& batch) {
+            for (std::size_t l = 0; l < LANES; l++) {
+                float ux = batch.x[1][l] - batch.x[0][l];
+                float uy = batch.y[1][l] - batch.y[0][l];
+                float uz = batch.z[1][l] - batch.z[0][l];
+                float vx = batch.x[2][l] - batch.x[0][l];
+                float vy = batch.y[2][l] - batch.y[0][l];
+                float vz = batch.z[2][l] - batch.z[0][l];
+
+                float wx = uy * vz - uz * vy;
+                float wy = uz * vx - ux * vz;
+                float wz = ux * vy - uy * vx;
+                batch.area[l] = std::sqrt(wx * wx + wy * wy + wz * wz) / 2.0f;
+            }
+        }
+
+        // same element matrix as stiffness3 in shaders/tomos.kernel
+        void
+        matrices(Batch& batch, float thickness) {
+            areas(batch);
+            for (std::size_t l = 0; l < LANES; l++) {
+                float scalar = (thickness * batch.sigma[l]) / (4.0f * batch.area[l]);
+
+                float bs[NODES] = {
+                      batch.y[1][l] - batch.y[2][l]
+                    , batch.y[2][l] - batch.y[0][l]
+                    , batch.y[0][l] - batch.y[1][l]
+                };
+                float gs[NODES] = {
+                      batch.x[2][l] - batch.x[1][l]
+                    , batch.x[0][l] - batch.x[2][l]
+                    , batch.x[1][l] - batch.x[0][l]
+                };
+                for (std::size_t i = 0; i < NODES; i++) {
+                for (std::size_t j = 0; j < NODES; j++) {
+                    batch.ks[i + NODES * j][l] = scalar * (bs[i] * bs[j] + gs[i] * gs[j]);
+                }
+                }
+            }
+        }
+
+        template <typename F>
+        void
+        batches(std::size_t first, std::size_t last, F&& f) {
+            for (std::size_t i = first; i < last; i += LANES) {
+                f(i, std::min(LANES, last - i));
+            }
+        }
+    } // namespace
+
+    Native::Native(const tomos::mesh::Mesh& mesh, std::size_t threads, const kernel::Options& options)
+        : Native(std::make_shared<Topology>(mesh), threads, options)
+    {}
+
+    Native::Native(std::shared_ptr<Topology> topology, std::size_t threads, const kernel::Options& options)
+        : topology_(std::move(topology))
+        , mesh_(topology_->mesh())
+        , pool_(threads)
+        , storage_(options.symmetric ? sparse::Storage::UPPER : sparse::Storage::FULL)
+        , thickness_(options.thickness)
+        , resistivity_(options.resistivity.value_or(1.0f))
+    {
+        if (options.nodes != NODES) {
+            throw std::domain_error("only three-node triangular elements are supported");
+        }
+        for (const tomos::mesh::Element& e : mesh_.elements) {
+            if (e.nodes.size() != NODES) {
+                throw std::domain_error("only three-node triangular elements are supported");
+            }
+        }
+    }
+
+    std::vector<float>
+    Native::area() {
+        std::vector<float> values(mesh_.elements.size());
+
+        pool_.for_each(0, values.size(), [&](std::size_t first, std::size_t last) {
+            Batch batch;
+            batches(first, last, [&](std::size_t offset, std::size_t count) {
+                for (std::size_t l = 0; l < LANES; l++) { load(mesh_, offset + ((l < count) ? l : 0), l, batch); }
+                areas(batch);
+                for (std::size_t l = 0; l < count; l++) { values[offset + l] = batch.area[l]; }
+            });
+        }, GRAIN);
+        return values;
+    }
+
+    std::vector<tomos::mesh::Node>
+    Native::centroid() {
+        std::vector<tomos::mesh::Node> values(mesh_.elements.size());
+
+        pool_.for_each(0, values.size(), [&](std::size_t first, std::size_t last) {
+            for (std::size_t e = first; e < last; e++) {
+                const tomos::mesh::Element& element = mesh_.elements[e];
+
+                tomos::mesh::Node c = {{0.0f, 0.0f, 0.0f, 0.0f}};
+                for (std::size_t n = 0; n < NODES; n++) {
+                    const tomos::mesh::Node& node = mesh_.nodes[element.nodes[n]];
+                    for (std::size_t k = 0; k < 3; k++) { c.s[k] += node.s[k] / 3.0f; }
+                }
+                values[e] = c;
+            }
+        }, GRAIN);
+        return values;
+    }
+
+    std::vector<tomos::mesh::Node>
+    Native::normal() {
+        std::vector<tomos::mesh::Node> values(mesh_.elements.size());
+
+        pool_.for_each(0, values.size(), [&](std::size_t first, std::size_t last) {
+            for (std::size_t e = first; e < last; e++) {
+                const tomos::mesh::Element& element = mesh_.elements[e];
+                const tomos::mesh::Node& a = mesh_.nodes[element.nodes[0]];
+                const tomos::mesh::Node& b = mesh_.nodes[element.nodes[1]];
+                const tomos::mesh::Node& c = mesh_.nodes[element.nodes[2]];
+
+                float u[3] = {b.s[0] - a.s[0], b.s[1] - a.s[1], b.s[2] - a.s[2]};
+                float v[3] = {c.s[0] - a.s[0], c.s[1] - a.s[1], c.s[2] - a.s[2]};
+
+                values[e] = {{
+                      u[1] * v[2] - u[2] * v[1]
+                    , u[2] * v[0] - u[0] * v[2]
+                    , u[0] * v[1] - u[1] * v[0]
+                    , 0.0f
+                }};
+            }
+        }, GRAIN);
+        return values;
+    }
+
+    std::vector<float>
+    Native::color() { return this->stiffness({}); }
+
+    void
+    Native::strategy(Strategy strategy) {
+        if (strategy != strategy_) { plan_.reset(); }
+        strategy_ = strategy;
+    }
+
+    std::vector<float>
+    Native::stiffness(std::span<const float> conductivity) {
+        if (not conductivity.empty() and conductivity.size() != mesh_.elements.size()) {
+            throw std::invalid_argument("conductivity does not match the number of elements");
+        }
+        const Plan& plan = this->plan();
+
+        if (strategy_ == Strategy::PARTITION) {
+            std::vector<float> values(plan.nonzeros + plan.copies, 0.0f);
+            const std::size_t entries = plan.entries.size();
+
+            // exclusive nonzeros and private copies are disjoint between partitions
+            pool_.for_each(0, plan.offsets.size() - 1, [&](std::size_t first, std::size_t last) {
+                Batch batch;
+                for (std::size_t p = first; p < last; p++) {
+                    batches(plan.offsets[p], plan.offsets[p + 1], [&](std::size_t offset, std::size_t count) {
+                        gather(mesh_, plan.order.data() + offset, count, conductivity, resistivity_, batch);
+                        matrices(batch, thickness_);
+
+                        for (std::size_t l = 0; l < count; l++) {
+                            const std::uint32_t * targets = plan.targets.data() + entries * (offset + l);
+                            for (std::size_t j = 0; j < entries; j++) {
+                                values[targets[j]] += batch.ks[plan.entries[j]][l];
+                            }
+                        }
+                    });
+                }
+            }, 1);
+
+            pool_.for_each(0, plan.interface.size(), [&](std::size_t first, std::size_t last) {
+                for (std::size_t k = first; k < last; k++) {
+                    float value = 0.0f;
+                    for (std::size_t i = plan.segments[k]; i < plan.segments[k + 1]; i++) {
+                        value += values[plan.sources[i]];
+                    }
+                    values[plan.interface[k]] = value;
+                }
+            }, GRAIN);
+
+            values.resize(plan.nonzeros);
+            return values;
+        }
+
+        std::vector<float> values(plan.nonzeros, 0.0f);
+
+        // elements of one color share no node, each color is a race-free parallel loop
+        for (std::size_t color = 0; color + 1 < plan.offsets.size(); color++) {
+            pool_.for_each(plan.offsets[color], plan.offsets[color + 1], [&](std::size_t first, std::size_t last) {
+                Batch batch;
+                batches(first, last, [&](std::size_t offset, std::size_t count) {
+                    gather(mesh_, plan.order.data() + offset, count, conductivity, resistivity_, batch);
+                    matrices(batch, thickness_);
+
+                    for (std::size_t l = 0; l < count; l++) {
+                        const std::uint32_t * slots = plan.indices.data() + plan.entries.size() * plan.order[offset + l];
+                        for (std::size_t j = 0; j < plan.entries.size(); j++) {
+                            values[slots[j]] += batch.ks[plan.entries[j]][l];
+                        }
+                    }
+                });
+            }, GRAIN);
+        }
+        return values;
+    }
+
+    const Native::Plan&
+    Native::plan() {
+        if (plan_) { return *plan_; }
+
+        Plan plan;
+        plan.nonzeros   = topology_->pattern(storage_).cols.size();
+        plan.copies     = 0;
+        plan.offsets    = {0};
+
+        if (strategy_ == Strategy::COLOR) {
+            const color::Colors& colors = topology_->colors(metis::Common::NODE);
+            plan.order      = colors.order;
+            plan.offsets    = colors.offsets;
+        } else {
+            // one partition per thread, so a fixed thread count fixes the summation order
+            std::size_t count = std::max<std::size_t>(1, std::min(pool_.size(), mesh_.elements.size()));
+            for (const auto& [_, elements] : topology_->partitions(count)) {
+                plan.order.insert(plan.order.end(), elements.begin(), elements.end());
+                plan.offsets.push_back(plan.order.size());
+            }
+        }
+
+        // slot order of sparse::scatter, the upper triangle row by row when symmetric
+        for (std::size_t i = 0; i < NODES; i++) {
+        for (std::size_t j = (storage_ == sparse::Storage::UPPER) ? i : 0; j < NODES; j++) {
+            plan.entries.push_back(NODES * i + j);
+        }
+        }
+        plan.indices = topology_->scatter(storage_);
+
+        if (strategy_ == Strategy::PARTITION) { this->partitioned(plan); }
+        plan_ = std::move(plan);
+        return *plan_;
+    }
+
+    void
+    Native::partitioned(Plan& plan) {
+        const std::size_t entries   = plan.entries.size();
+        const std::size_t count     = plan.offsets.size() - 1;
+        const std::size_t unused    = std::numeric_limits<std::size_t>::max();
+
+        // nonzeros written by more than one partition
+        std::vector<std::size_t> owner(plan.nonzeros, unused);
+        std::vector<bool> shared(plan.nonzeros, false);
+        for (std::size_t p = 0; p < count; p++) {
+            for (std::size_t i = plan.offsets[p]; i < plan.offsets[p + 1]; i++) {
+                for (std::size_t j = 0; j < entries; j++) {
+                    std::uint32_t slot = plan.indices[entries * plan.order[i] + j];
+                    if (owner[slot] == unused) { owner[slot] = p; }
+                    else if (owner[slot] != p) { shared[slot] = true; }
+                }
+            }
+        }
+
+        // every partition gets one private copy of each interface nonzero it touches,
+        // numbered after the nonzeros in partition order
+        std::vector<std::size_t> seen(plan.nonzeros, 0);
+        std::vector<std::uint32_t> copy(plan.nonzeros, 0);
+        std::vector<std::uint32_t> slots;
+        plan.targets.resize(entries * plan.order.size());
+        for (std::size_t p = 0; p < count; p++) {
+            for (std::size_t i = plan.offsets[p]; i < plan.offsets[p + 1]; i++) {
+                for (std::size_t j = 0; j < entries; j++) {
+                    std::uint32_t slot = plan.indices[entries * plan.order[i] + j];
+                    if (shared[slot] and seen[slot] != p + 1) {
+                        seen[slot] = p + 1;
+                        copy[slot] = static_cast<std::uint32_t>(plan.nonzeros + plan.copies++);
+                        slots.push_back(slot);
+                    }
+                    plan.targets[entries * i + j] = shared[slot] ? copy[slot] : slot;
+                }
+            }
+        }
+
+        // counting sort of the copies by nonzero, stable so partitions stay in order
+        std::vector<std::size_t> position(plan.nonzeros, unused);
+        for (std::size_t slot = 0; slot < plan.nonzeros; slot++) {
+            if (shared[slot]) {
+                position[slot] = plan.interface.size();
+                plan.interface.push_back(static_cast<std::uint32_t>(slot));
+            }
+        }
+        plan.segments.assign(plan.interface.size() + 1, 0);
+        for (const std::uint32_t& slot : slots) { plan.segments[position[slot] + 1]++; }
+        std::partial_sum(plan.segments.begin(), plan.segments.end(), plan.segments.begin());
+
+        plan.sources.resize(slots.size());
+        std::vector<std::size_t> cursor(plan.segments.begin(), plan.segments.end() - 1);
+        for (std::size_t c = 0; c < slots.size(); c++) {
+            plan.sources[cursor[position[slots[c]]]++] = static_cast<std::uint32_t>(plan.nonzeros + c);
+        }
+    }
+} // namespace tomos
@@ -0,0 +1,94 @@
+#include "tomos/tomos-parallel.hpp"
+
+#include <algorithm>
+
+namespace tomos {
+namespace parallel {
+    std::size_t
+    concurrency() {
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    Pool::Pool(std::size_t threads) {
+        for (std::size_t i = 1; i < std::max<std::size_t>(1, threads); i++) {
+            workers_.emplace_back([this]() { this->work(); });
+        }
+    }
+
+    Pool::~Pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) { worker.join(); }
+    }
+
+    std::size_t
+    Pool::size() const { return workers_.size() + 1; }
+
+    void
+    Pool::for_each(std::size_t first, std::size_t last, const Body& body, std::size_t grain) {
+        if (first >= last) { return; }
+
+        grain = std::max<std::size_t>(1, grain);
+        if (workers_.empty() or (last - first) <= grain) {
+            body(first, last);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            body_   = &body;
+            last_   = last;
+            grain_  = grain;
+            next_   = first;
+            error_  = nullptr;
+            active_ = workers_.size();
+            generation_++;
+        }
+        wake_.notify_all();
+        this->run();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return active_ == 0; });
+        body_ = nullptr;
+
+        if (error_) { std::rethrow_exception(error_); }
+    }
+
+    void
+    Pool::work() {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this, seen]() { return stop_ or generation_ != seen; });
+                if (stop_) { return; }
+                seen = generation_;
+            }
+            this->run();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                active_--;
+            }
+            done_.notify_one();
+        }
+    }
+
+    void
+    Pool::run() {
+        while (true) {
+            std::size_t first = next_.fetch_add(grain_);
+            if (first >= last_) { return; }
+
+            std::size_t last = std::min(last_, first + grain_);
+            try {
+                (*body_)(first, last);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (not error_) { error_ = std::current_exception(); }
+            }
+        }
+    }
+} // namespace parallel
+} // namespace tomos
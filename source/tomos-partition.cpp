@@ -1,80 +1,406 @@
 #include "tomos/tomos-partition.hpp"
 #include "tomos/tomos-metis.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
 namespace tomos {
 namespace partition {
-    bool
-    valid(const tomos::mesh::Mesh& mesh, const Partitions& ps, std::size_t limit) {
-        std::map<Partition, std::size_t> nodal;
+    Partitions
+    Layout::partitions() const {
+        Partitions values;
+        for (std::size_t p = 0; p + 1 < offsets.size(); p++) {
+            if (offsets[p] == offsets[p + 1]) { continue; }
+            values[p] = Indices(elements.begin() + offsets[p], elements.begin() + offsets[p + 1]);
+        }
+        return values;
+    }
 
-        for (const auto& [p, indices] : ps) {
-            using tomos::mesh::node::Number;
+    Layout
+    layout(std::vector<Partition> part, std::size_t count) {
+        Layout values;
+        values.offsets.assign(count + 1, 0);
+        for (const Partition& p : part) {
+            if (p >= count) { throw std::out_of_range("partition out of range"); }
+            values.offsets[p + 1]++;
+        }
+        std::partial_sum(values.offsets.begin(), values.offsets.end(), values.offsets.begin());
 
-            std::set<Number> nodes;
-            for (const Index& index : indices) {
-                const tomos::mesh::Element& element = mesh.elements[index];
-                for (const Number& node : element.nodes) { nodes.insert(node); }
-            }
-            if (nodes.size() > limit) { return false; }
+        values.elements.resize(part.size());
+        std::vector<std::size_t> cursor(values.offsets.begin(), values.offsets.end() - 1);
+        for (std::size_t e = 0; e < part.size(); e++) { values.elements[cursor[part[e]]++] = e; }
+
+        values.part = std::move(part);
+        return values;
+    }
+
+    float
+    imbalance(const Layout& layout, const std::vector<std::size_t>& weights, const std::vector<float>& targets) {
+        std::size_t count = layout.offsets.size() - 1;
+        if (count == 0) { return 1.0f; }
+
+        std::vector<double> loads(count, 0.0);
+        for (std::size_t e = 0; e < layout.part.size(); e++) {
+            loads[layout.part[e]] += weights.empty() ? 1.0 : static_cast<double>(weights[e]);
         }
-        return true;
+        double total = std::accumulate(loads.begin(), loads.end(), 0.0);
+        double share = std::accumulate(targets.begin(), targets.end(), 0.0);
+        if (total == 0.0) { return 1.0f; }
+
+        double value = 0.0;
+        for (std::size_t p = 0; p < count; p++) {
+            double target = targets.empty() ? 1.0 / static_cast<double>(count) : targets[p] / share;
+            if (target > 0.0) { value = std::max(value, loads[p] / (target * total)); }
+        }
+        return static_cast<float>(value);
     }
 
-    using Bounds = std::pair<std::size_t, std::size_t>;
+    namespace {
+        // unique nodes of a list of elements, seen[n] == epoch marks the
+        // nodes already counted so no marker is cleared between lists
+        std::size_t
+        unique(
+                  const tomos::mesh::Mesh&  mesh
+                , const Index *             first
+                , const Index *             last
+                , std::vector<std::size_t>& seen
+                , std::size_t               epoch
+              )
+        {
+            std::size_t count = 0;
+            for (const Index * e = first; e != last; e++) {
+                for (const tomos::mesh::node::Number& node : mesh.elements[*e].nodes) {
+                    if (seen[node] != epoch) {
+                        seen[node] = epoch;
+                        count++;
+                    }
+                }
+            }
+            return count;
+        }
 
-    Bounds
-    guess(metis::Dual& dual, const tomos::mesh::Mesh& mesh, std::size_t limit) {
-        std::size_t prev = 1;
-        std::size_t next = 2;
+        // whether a k-way partitioning into count parts fits the limit; METIS
+        // draws from the process-wide GKlib random state, so it runs on the
+        // calling thread and only the node count is spread over pool
+        bool
+        fits(const metis::Dual& dual, const tomos::mesh::Mesh& mesh, std::size_t count, std::size_t limit, parallel::Pool& pool) {
+            Options options;
+            options.count = count;
+            return statistics(mesh, dual.partition(options), pool).maximum <= limit;
+        }
 
-        while (true) {
-            Partitions ps = dual.partition(next);
-            if (valid(mesh, ps, limit)) {
-                return {prev, next}; 
-            } else {
-                prev = next;
-                next = 2 * prev;
+        // two halves of a list of elements from METIS on the induced dual
+        // subgraph, local[e] is -1 for every element outside of it
+        std::pair<Indices, Indices>
+        split(const metis::Dual& dual, const Indices& elements, std::vector<idx_t>& local) {
+            for (std::size_t i = 0; i < elements.size(); i++) { local[elements[i]] = static_cast<idx_t>(i); }
+
+            std::vector<idx_t> xadj = {0};
+            std::vector<idx_t> adjncy;
+            for (const Index& e : elements) {
+                for (const idx_t& v : dual.neighbours(e)) {
+                    if (local[v] >= 0) { adjncy.push_back(local[v]); }
+                }
+                xadj.push_back(static_cast<idx_t>(adjncy.size()));
+            }
+            for (const Index& e : elements) { local[e] = -1; }
+
+            idx_t vertices  = static_cast<idx_t>(elements.size());
+            idx_t ncon      = 1;
+            idx_t nparts    = 2;
+            idx_t edgecut   = 0;
+            std::vector<idx_t> part(elements.size(), 0);
+
+            idx_t options[METIS_NOPTIONS];
+            METIS_SetDefaultOptions(options);
+            METIS_PartGraphRecursive(
+                      &vertices, &ncon, xadj.data(), adjncy.data()
+                    , NULL, NULL, NULL, &nparts, NULL, NULL, options, &edgecut, part.data()
+                    );
+
+            std::pair<Indices, Indices> halves;
+            for (std::size_t i = 0; i < elements.size(); i++) {
+                (part[i] == 0 ? halves.first : halves.second).push_back(elements[i]);
             }
+            // METIS may leave a side empty on tiny or disconnected inputs
+            if (halves.first.empty() or halves.second.empty()) {
+                std::size_t mean = elements.size() / 2;
+                halves = {
+                      Indices(elements.begin(), elements.begin() + mean)
+                    , Indices(elements.begin() + mean, elements.end())
+                };
+            }
+            return halves;
+        }
+
+        // one marker array per worker, allocated once per call; markers are
+        // stamped with an epoch so they are never cleared between partitions
+        using Markers = std::vector<std::vector<std::uint32_t>>;
+
+        Markers
+        markers(const tomos::mesh::Mesh& mesh, const parallel::Pool& pool, std::size_t count) {
+            if (2 * count >= std::numeric_limits<std::uint32_t>::max()) {
+                throw std::overflow_error("too many partitions for 32-bit markers");
+            }
+            return Markers(std::min(pool.size(), count), std::vector<std::uint32_t>(mesh.nodes.size(), 0));
         }
-        return {prev, next}; 
+
+        // body(worker, p) for every partition p, worker w takes partitions
+        // w, w + workers, ... so each worker owns a single marker array
+        template <typename Function>
+        void
+        stripes(parallel::Pool& pool, std::size_t workers, std::size_t count, const Function& body) {
+            pool.for_each(0, workers, [&](std::size_t first, std::size_t last) {
+                for (std::size_t w = first; w < last; w++) {
+                    for (std::size_t p = w; p < count; p += workers) { body(w, p); }
+                }
+            }, 1);
+        }
+
+        // number of partitions touching every node, each partition counts a
+        // node once; stamps 1 to count
+        std::vector<std::atomic<std::uint32_t>>
+        touches(const tomos::mesh::Mesh& mesh, const Layout& layout, parallel::Pool& pool, Markers& seen) {
+            const std::size_t count = layout.offsets.size() - 1;
+
+            std::vector<std::atomic<std::uint32_t>> values(mesh.nodes.size());
+            stripes(pool, seen.size(), count, [&](std::size_t w, std::size_t p) {
+                const std::uint32_t epoch = static_cast<std::uint32_t>(p + 1);
+                for (std::size_t i = layout.offsets[p]; i < layout.offsets[p + 1]; i++) {
+                    for (const tomos::mesh::node::Number& node : mesh.elements[layout.elements[i]].nodes) {
+                        if (seen[w][node] != epoch) {
+                            seen[w][node] = epoch;
+                            values[node].fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            });
+            return values;
+        }
+    } // namespace
+
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Layout& layout, parallel::Pool& pool) {
+        const std::size_t count = layout.offsets.empty() ? 0 : layout.offsets.size() - 1;
+
+        Statistics values;
+        values.nodes.assign(count, 0);
+        values.halo.assign(count, 0);
+        if (count == 0) { return values; }
+
+        Markers seen = markers(mesh, pool, count);
+        std::vector<std::atomic<std::uint32_t>> shared = touches(mesh, layout, pool, seen);
+
+        // halo nodes are shared with at least one other partition, stamps
+        // count + 1 to 2 count keep the markers of the first pass valid
+        stripes(pool, seen.size(), count, [&](std::size_t w, std::size_t p) {
+            const std::uint32_t epoch = static_cast<std::uint32_t>(count + p + 1);
+            for (std::size_t i = layout.offsets[p]; i < layout.offsets[p + 1]; i++) {
+                for (const tomos::mesh::node::Number& node : mesh.elements[layout.elements[i]].nodes) {
+                    if (seen[w][node] != epoch) {
+                        seen[w][node] = epoch;
+                        values.nodes[p]++;
+                        if (shared[node].load(std::memory_order_relaxed) > 1) { values.halo[p]++; }
+                    }
+                }
+            }
+        });
+
+        values.maximum = *std::max_element(values.nodes.begin(), values.nodes.end());
+        return values;
     }
 
-    bool
-    complete(const Bounds& bounds) {
-        return (bounds.first >= bounds.second) 
-            or ((bounds.second - bounds.first) == 1)
-            ;
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Layout& layout, std::size_t threads) {
+        parallel::Pool pool(std::max<std::size_t>(1, threads));
+        return statistics(mesh, layout, pool);
     }
 
-    Bounds
-    bissect(
-              metis::Dual&              dual
-            , const tomos::mesh::Mesh&  mesh
-            , Bounds                    bounds
-            , std::size_t               limits
-           )
-    {
-        std::size_t mean = (bounds.second + bounds.first) / 2;
-        if (valid(mesh, dual.partition(mean), limits)) {
-            return {bounds.first, mean};
-        } else {
-            return {mean, bounds.second};
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Partitions& ps, parallel::Pool& pool) {
+        Layout flat;
+        flat.offsets = {0};
+        for (const auto& [_, indices] : ps) {
+            flat.elements.insert(flat.elements.end(), indices.begin(), indices.end());
+            flat.offsets.push_back(flat.elements.size());
         }
+        return statistics(mesh, flat, pool);
+    }
+
+    Statistics
+    statistics(const tomos::mesh::Mesh& mesh, const Partitions& ps, std::size_t threads) {
+        parallel::Pool pool(std::max<std::size_t>(1, threads));
+        return statistics(mesh, ps, pool);
+    }
+
+    bool
+    valid(const tomos::mesh::Mesh& mesh, const Partitions& ps, std::size_t limit) {
+        return statistics(mesh, ps).maximum <= limit;
     }
 
     std::size_t
-    optimal(const tomos::mesh::Mesh& mesh, std::size_t limit) {
-        if (mesh.nodes.size() < limit) { 
-            return 1; 
+    optimal(const tomos::mesh::Mesh& mesh, std::size_t limit, std::size_t threads) {
+        if (mesh.nodes.size() <= limit) {
+            return 1;
         } else {
             metis::Dual dual(mesh, metis::Common::EDGE);
+            return optimal(dual, mesh, limit, threads);
+        }
+    }
+
+    std::size_t
+    optimal(const metis::Dual& dual, const tomos::mesh::Mesh& mesh, std::size_t limit, std::size_t threads) {
+        if (mesh.nodes.size() <= limit) { return 1; }
+        if (limit == 0) { throw std::domain_error("node limit must be greater than 0"); }
+
+        const std::size_t elements = mesh.elements.size();
+        parallel::Pool pool(std::max<std::size_t>(1, threads));
+
+        std::map<std::size_t, bool> memo;
+        auto probe = [&](const std::vector<std::size_t>& counts) {
+            std::vector<std::size_t> pending;
+            for (const std::size_t& c : counts) {
+                if (memo.find(c) == memo.end()) { pending.push_back(c); }
+            }
+            for (const std::size_t& c : pending) { memo[c] = fits(dual, mesh, c, limit, pool); }
+        };
+
+        // every node lies in some partition, fewer than nodes / limit
+        // partitions cannot fit; low is known to fail, high to fit
+        std::size_t low     = (mesh.nodes.size() + limit - 1) / limit - 1;
+        std::size_t high    = 0;
+        std::size_t width   = pool.size();
+
+        // geometric ladder above low, one doubling per round split into width probes
+        while (high == 0) {
+            if (low >= elements) {
+                throw std::domain_error("no partition count keeps every partition within the node limit");
+            }
+            std::vector<std::size_t> counts = {low + 1};
+            for (std::size_t i = 1; i < width; i++) {
+                double step = std::pow(2.0, static_cast<double>(i) / static_cast<double>(width));
+                std::size_t c = static_cast<std::size_t>(std::ceil(static_cast<double>(low + 1) * step));
+                counts.push_back(std::min(elements, std::max(c, counts.back() + 1)));
+            }
+            counts.push_back(std::min(elements, 2 * (low + 1)));
+            std::sort(counts.begin(), counts.end());
+            counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+
+            probe(counts);
+            for (const std::size_t& c : counts) {
+                if (memo[c]) { high = c; break; }
+                low = c;
+            }
+        }
+
+        // multisection of (low, high) with width probes per round
+        while (high - low > 1) {
+            std::vector<std::size_t> counts;
+            std::size_t gap = high - low;
+            for (std::size_t i = 1; i <= width; i++) {
+                std::size_t c = low + (gap * i) / (width + 1);
+                if (c > low and c < high and (counts.empty() or c != counts.back())) { counts.push_back(c); }
+            }
+            if (counts.empty()) { counts.push_back(low + gap / 2); }
+
+            probe(counts);
+            for (const std::size_t& c : counts) {
+                if (memo[c]) { high = c; break; }
+                low = c;
+            }
+        }
+        return high;
+    }
+
+    Layout
+    bisection(const metis::Dual& dual, const tomos::mesh::Mesh& mesh, std::size_t limit) {
+        std::vector<std::size_t> seen(mesh.nodes.size(), 0);
+        std::vector<idx_t> local(mesh.elements.size(), -1);
+        std::size_t epoch = 0;
+
+        Indices all(mesh.elements.size());
+        std::iota(all.begin(), all.end(), 0);
+
+        std::vector<Indices> pending = {all};
+        std::vector<Partition> part(mesh.elements.size(), 0);
+        std::size_t count = 0;
+
+        while (not pending.empty()) {
+            Indices elements = std::move(pending.back());
+            pending.pop_back();
 
-            Bounds bounds = guess(dual, mesh, limit);
-            while(not complete(bounds)) {
-                bounds = bissect(dual, mesh, bounds, limit);
+            std::size_t nodes = unique(mesh, elements.data(), elements.data() + elements.size(), seen, ++epoch);
+            if (nodes <= limit) {
+                for (const Index& e : elements) { part[e] = count; }
+                count++;
+            } else if (elements.size() == 1) {
+                throw std::domain_error("an element exceeds the node limit");
+            } else {
+                auto [first, second] = split(dual, elements, local);
+                pending.push_back(std::move(second));
+                pending.push_back(std::move(first));
             }
-            return bounds.second;
         }
+        return layout(std::move(part), std::max<std::size_t>(count, 1));
+    }
+
+    std::vector<Submesh>
+    submeshes(const tomos::mesh::Mesh& mesh, const Layout& layout, parallel::Pool& pool) {
+        const std::size_t count = layout.offsets.empty() ? 0 : layout.offsets.size() - 1;
+
+        std::vector<Submesh> values(count);
+        if (count == 0) { return values; }
+
+        Markers seen = markers(mesh, pool, count);
+        std::vector<std::atomic<std::uint32_t>> shared = touches(mesh, layout, pool, seen);
+        std::vector<std::vector<Local>> local(seen.size(), std::vector<Local>(mesh.nodes.size(), 0));
+
+        stripes(pool, seen.size(), count, [&](std::size_t w, std::size_t p) {
+            const std::uint32_t epoch = static_cast<std::uint32_t>(count + p + 1);
+
+            Submesh& submesh = values[p];
+            submesh.elements.assign(layout.elements.begin() + layout.offsets[p], layout.elements.begin() + layout.offsets[p + 1]);
+
+            // interior nodes first, then the halo
+            std::vector<tomos::mesh::node::Number> halo;
+            for (const Index& e : submesh.elements) {
+                for (const tomos::mesh::node::Number& node : mesh.elements[e].nodes) {
+                    if (seen[w][node] == epoch) { continue; }
+                    seen[w][node] = epoch;
+                    if (shared[node].load(std::memory_order_relaxed) > 1) {
+                        halo.push_back(node);
+                    } else {
+                        submesh.nodes.push_back(node);
+                    }
+                }
+            }
+            submesh.interior = submesh.nodes.size();
+            submesh.nodes.insert(submesh.nodes.end(), halo.begin(), halo.end());
+
+            if (submesh.nodes.size() > std::size_t{std::numeric_limits<Local>::max()} + 1) {
+                throw std::overflow_error("partition has too many nodes for local numbering");
+            }
+            for (std::size_t i = 0; i < submesh.nodes.size(); i++) { local[w][submesh.nodes[i]] = static_cast<Local>(i); }
+
+            submesh.offsets = {0};
+            for (const Index& e : submesh.elements) {
+                for (const tomos::mesh::node::Number& node : mesh.elements[e].nodes) {
+                    submesh.connectivity.push_back(local[w][node]);
+                }
+                submesh.offsets.push_back(submesh.connectivity.size());
+            }
+        });
+        return values;
+    }
+
+    std::vector<Submesh>
+    submeshes(const tomos::mesh::Mesh& mesh, const Layout& layout, std::size_t threads) {
+        parallel::Pool pool(std::max<std::size_t>(1, threads));
+        return submeshes(mesh, layout, pool);
     }
 } // namespace partition
 } // namespace tomos
@@ -0,0 +1,315 @@
+#include "tomos/tomos-reorder.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace tomos {
+namespace reorder {
+    namespace {
+        using Key = std::uint64_t;
+
+        const Key SIDE = 1 << 16;   // curve resolution per axis
+
+        // breadth-first level structure rooted at root, seen[i] == epoch
+        // marks the nodes reached; returns the last level and the depth
+        std::pair<std::vector<Index>, std::size_t>
+        levels(
+                  std::span<const idx_t>    xadj
+                , std::span<const idx_t>    adjncy
+                , Index                     root
+                , std::vector<std::size_t>& seen
+                , std::size_t               epoch
+              )
+        {
+            std::vector<Index> current  = {root};
+            std::vector<Index> next     = {};
+            std::size_t depth           = 0;
+            seen[root]                  = epoch;
+
+            while (true) {
+                next.clear();
+                for (const Index& node : current) {
+                    for (idx_t j = xadj[node]; j < xadj[node + 1]; j++) {
+                        Index neighbour = static_cast<Index>(adjncy[j]);
+                        if (seen[neighbour] != epoch) {
+                            seen[neighbour] = epoch;
+                            next.push_back(neighbour);
+                        }
+                    }
+                }
+                if (next.empty()) { return {current, depth}; }
+                std::swap(current, next);
+                depth++;
+            }
+        }
+
+        Ordering
+        sorted(const std::vector<Key>& keys) {
+            Permutation order(keys.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](Index a, Index b) { return keys[a] < keys[b]; });
+            return ordering(std::move(order));
+        }
+
+        // element centroids quantized to [0, SIDE) on both axes
+        std::vector<std::pair<Key, Key>>
+        quantize(const tomos::mesh::Mesh& mesh) {
+            std::vector<std::pair<float, float>> centroids(mesh.elements.size());
+
+            float lx = std::numeric_limits<float>::max(), hx = std::numeric_limits<float>::lowest();
+            float ly = std::numeric_limits<float>::max(), hy = std::numeric_limits<float>::lowest();
+            for (std::size_t e = 0; e < mesh.elements.size(); e++) {
+                const tomos::mesh::node::Numbers& nodes = mesh.elements[e].nodes;
+
+                float x = 0.0f, y = 0.0f;
+                for (const tomos::mesh::node::Number& n : nodes) {
+                    x += mesh.nodes[n].s[0];
+                    y += mesh.nodes[n].s[1];
+                }
+                x /= static_cast<float>(nodes.size());
+                y /= static_cast<float>(nodes.size());
+                centroids[e] = {x, y};
+
+                lx = std::min(lx, x); hx = std::max(hx, x);
+                ly = std::min(ly, y); hy = std::max(hy, y);
+            }
+
+            auto scale = [](float value, float low, float high) -> Key {
+                if (not (high > low)) { return 0; }
+                double t = static_cast<double>(value - low) / static_cast<double>(high - low);
+                return std::min(static_cast<Key>(t * static_cast<double>(SIDE)), SIDE - 1);
+            };
+
+            std::vector<std::pair<Key, Key>> values(centroids.size());
+            for (std::size_t e = 0; e < centroids.size(); e++) {
+                values[e] = {scale(centroids[e].first, lx, hx), scale(centroids[e].second, ly, hy)};
+            }
+            return values;
+        }
+
+        // spreads the low 16 bits so one zero bit separates each of them
+        Key
+        spread(Key x) {
+            x = (x | (x << 8)) & 0x00ff00ff;
+            x = (x | (x << 4)) & 0x0f0f0f0f;
+            x = (x | (x << 2)) & 0x33333333;
+            x = (x | (x << 1)) & 0x55555555;
+            return x;
+        }
+
+        Key
+        curve(Key x, Key y) {
+            Key d = 0;
+            for (Key s = SIDE / 2; s > 0; s /= 2) {
+                Key rx = (x & s) ? 1 : 0;
+                Key ry = (y & s) ? 1 : 0;
+                d += s * s * ((3 * rx) ^ ry);
+
+                // rotate the quadrant so the curve stays continuous
+                if (ry == 0) {
+                    if (rx == 1) {
+                        x = SIDE - 1 - x;
+                        y = SIDE - 1 - y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return d;
+        }
+    } // namespace
+
+    Ordering
+    identity(std::size_t count) {
+        Permutation order(count);
+        std::iota(order.begin(), order.end(), 0);
+        return {order, order};
+    }
+
+    Ordering
+    ordering(Permutation order) {
+        Permutation rank(order.size(), std::numeric_limits<Index>::max());
+        for (std::size_t i = 0; i < order.size(); i++) {
+            if (order[i] >= order.size() or rank[order[i]] != std::numeric_limits<Index>::max()) {
+                throw std::invalid_argument("order is not a permutation");
+            }
+            rank[order[i]] = static_cast<Index>(i);
+        }
+        return {std::move(order), std::move(rank)};
+    }
+
+    Ordering
+    rcm(const metis::Nodal& nodal) {
+        std::span<const idx_t> xadj     = nodal.offsets();
+        std::span<const idx_t> adjncy   = nodal.neighbours();
+        std::size_t count               = nodal.size();
+
+        auto degree = [&](Index node) { return xadj[node + 1] - xadj[node]; };
+
+        // components are started from their lowest degree node
+        Permutation starts(count);
+        std::iota(starts.begin(), starts.end(), 0);
+        std::stable_sort(starts.begin(), starts.end(), [&](Index a, Index b) { return degree(a) < degree(b); });
+
+        std::vector<std::size_t> seen(count, 0);
+        std::size_t epoch = 0;
+
+        std::vector<bool> placed(count, false);
+        Permutation order;
+        order.reserve(count);
+
+        std::vector<Index> neighbours;
+        for (const Index& start : starts) {
+            if (placed[start]) { continue; }
+
+            // George-Liu: move to the lowest degree node of the last level
+            // while the level structure keeps getting deeper
+            Index root                  = start;
+            auto [last, depth]          = levels(xadj, adjncy, root, seen, ++epoch);
+            while (true) {
+                Index candidate = *std::min_element(last.begin(), last.end(), [&](Index a, Index b) {
+                    return degree(a) < degree(b);
+                });
+                auto [further, deeper] = levels(xadj, adjncy, candidate, seen, ++epoch);
+                if (deeper <= depth) { break; }
+                root    = candidate;
+                last    = std::move(further);
+                depth   = deeper;
+            }
+
+            std::size_t head = order.size();
+            order.push_back(root);
+            placed[root] = true;
+            while (head < order.size()) {
+                Index node = order[head++];
+
+                neighbours.clear();
+                for (idx_t j = xadj[node]; j < xadj[node + 1]; j++) {
+                    Index neighbour = static_cast<Index>(adjncy[j]);
+                    if (not placed[neighbour]) {
+                        placed[neighbour] = true;
+                        neighbours.push_back(neighbour);
+                    }
+                }
+                std::stable_sort(neighbours.begin(), neighbours.end(), [&](Index a, Index b) {
+                    return degree(a) < degree(b);
+                });
+                order.insert(order.end(), neighbours.begin(), neighbours.end());
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        return ordering(std::move(order));
+    }
+
+    Ordering
+    nested(const metis::Nodal& nodal) {
+        if (nodal.size() == 0) { return identity(0); }
+
+        std::vector<idx_t> xadj(nodal.offsets().begin(), nodal.offsets().end());
+        std::vector<idx_t> adjncy(nodal.neighbours().begin(), nodal.neighbours().end());
+        idx_t nvtxs = static_cast<idx_t>(nodal.size());
+
+        std::vector<idx_t> perm(nodal.size());
+        std::vector<idx_t> iperm(nodal.size());
+
+        idx_t options[METIS_NOPTIONS];
+        METIS_SetDefaultOptions(options);
+        options[METIS_OPTION_NUMBERING] = 0;
+
+        int status = METIS_NodeND(&nvtxs, xadj.data(), adjncy.data(), NULL, options, perm.data(), iperm.data());
+        if (status != METIS_OK) {
+            throw std::runtime_error("METIS_NodeND failed");
+        }
+        return ordering(Permutation(perm.begin(), perm.end()));
+    }
+
+    Ordering
+    morton(const tomos::mesh::Mesh& mesh) {
+        std::vector<std::pair<Key, Key>> points = quantize(mesh);
+
+        std::vector<Key> keys(points.size());
+        for (std::size_t e = 0; e < keys.size(); e++) {
+            keys[e] = spread(points[e].first) | (spread(points[e].second) << 1);
+        }
+        return sorted(keys);
+    }
+
+    Ordering
+    hilbert(const tomos::mesh::Mesh& mesh) {
+        std::vector<std::pair<Key, Key>> points = quantize(mesh);
+
+        std::vector<Key> keys(points.size());
+        for (std::size_t e = 0; e < keys.size(); e++) {
+            keys[e] = curve(points[e].first, points[e].second);
+        }
+        return sorted(keys);
+    }
+
+    Ordering
+    partitioned(const metis::Partitions& partitions, std::size_t elements) {
+        Permutation order;
+        order.reserve(elements);
+        for (const auto& [_, indices] : partitions) {
+            for (const metis::Index& index : indices) { order.push_back(static_cast<Index>(index)); }
+        }
+        if (order.size() != elements) {
+            throw std::invalid_argument("partitions do not cover every element");
+        }
+        return ordering(std::move(order));
+    }
+
+    Reordered
+    apply(const tomos::mesh::Mesh& mesh, const Ordering& nodes, const Ordering& elements) {
+        if (nodes.order.size() != mesh.nodes.size() or elements.order.size() != mesh.elements.size()) {
+            throw std::invalid_argument("orderings do not match the mesh");
+        }
+
+        Reordered values = {{}, nodes, elements};
+        values.mesh.nodes.resize(mesh.nodes.size());
+        for (std::size_t i = 0; i < mesh.nodes.size(); i++) {
+            values.mesh.nodes[i] = mesh.nodes[nodes.order[i]];
+        }
+
+        values.mesh.elements.reserve(mesh.elements.size());
+        for (std::size_t e = 0; e < mesh.elements.size(); e++) {
+            tomos::mesh::Element element = mesh.elements[elements.order[e]];
+            for (tomos::mesh::node::Number& n : element.nodes) { n = nodes.rank[n]; }
+            values.mesh.elements.push_back(std::move(element));
+        }
+        return values;
+    }
+
+    Reordered
+    build(const tomos::mesh::Mesh& mesh, const Options& options) {
+        Ordering nodes;
+        switch (options.nodes) {
+            case Nodes::NONE:   nodes = identity(mesh.nodes.size());        break;
+            case Nodes::RCM:    nodes = rcm(metis::Nodal(mesh));            break;
+            case Nodes::NESTED: nodes = nested(metis::Nodal(mesh));         break;
+        }
+
+        Ordering elements;
+        switch (options.elements) {
+            case Elements::NONE:    elements = identity(mesh.elements.size());  break;
+            case Elements::MORTON:  elements = morton(mesh);                    break;
+            case Elements::HILBERT: elements = hilbert(mesh);                   break;
+            case Elements::PARTITION: {
+                metis::Dual dual(mesh, metis::Common::EDGE);
+                elements = partitioned(dual.partition(options.parts), mesh.elements.size());
+                break;
+            }
+        }
+        return apply(mesh, nodes, elements);
+    }
+
+    std::size_t
+    bandwidth(const tomos::mesh::Mesh& mesh) {
+        std::size_t value = 0;
+        for (const tomos::mesh::Element& element : mesh.elements) {
+            auto [low, high] = std::minmax_element(element.nodes.begin(), element.nodes.end());
+            if (low != element.nodes.end()) { value = std::max(value, static_cast<std::size_t>(*high - *low)); }
+        }
+        return value;
+    }
+} // namespace reorder
+} // namespace tomos
@@ -1,45 +1,319 @@
 #include "tomos/tomos-sparse.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
 namespace tomos {
 namespace sparse {
     std::size_t
-    nonzeros(const metis::Nodal& nodal) {
-        metis::Adjacency adjacency  = nodal.adjacency();
-        std::size_t count           = 0;
+    entries(std::size_t nodes, Storage storage) {
+        return (storage == Storage::UPPER) ? nodes * (nodes + 1) / 2 : nodes * nodes;
+    }
 
-        for (const auto& [_, neighbours] : adjacency) { count += (1 + neighbours.size()); }
-        return count;
+    std::size_t
+    nonzeros(const metis::Nodal& nodal, Storage storage) {
+        std::size_t neighbours = nodal.neighbours().size();
+        if (storage == Storage::UPPER) { neighbours /= 2; }
+        return neighbours + nodal.size();
     }
 
-    std::pair<Indices, Indices>
-    csr(const metis::Nodal& nodal) {
-        metis::Adjacency adjacency = nodal.adjacency();
+    template <typename I>
+    void
+    csr(const metis::Nodal& nodal, std::span<I> rows, std::span<I> cols, Storage storage) {
+        std::span<const idx_t> xadj     = nodal.offsets();
+        std::span<const idx_t> adjncy   = nodal.neighbours();
+        std::size_t nodes               = nodal.size();
+        std::size_t count               = nonzeros(nodal, storage);
+        bool upper                      = (storage == Storage::UPPER);
+
+        if (rows.size() != nodes + 1 or cols.size() != count) {
+            throw std::length_error("csr buffers do not match the nodal graph");
+        }
+        if (count > static_cast<std::size_t>(std::numeric_limits<I>::max())) {
+            throw std::overflow_error("nonzeros do not fit the index type");
+        }
+
+        // every row gains its diagonal, the upper triangle keeps the
+        // neighbours numbered above the row only
+        rows[0] = 0;
+        for (std::size_t i = 0; i < nodes; i++) {
+            std::size_t width = static_cast<std::size_t>(xadj[i + 1] - xadj[i]);
+            if (upper) {
+                width = 0;
+                for (idx_t j = xadj[i]; j < xadj[i + 1]; j++) {
+                    if (static_cast<std::size_t>(adjncy[j]) > i) { width++; }
+                }
+            }
+            rows[i + 1] = static_cast<I>(static_cast<std::size_t>(rows[i]) + width + 1);
+        }
+
+        // the nodal graph is symmetric, visiting columns in increasing order
+        // and appending each to the rows it touches leaves every row sorted
+        std::vector<I> cursor(rows.begin(), rows.end() - 1);
+        for (std::size_t col = 0; col < nodes; col++) {
+            cols[cursor[col]++] = static_cast<I>(col);
+            for (idx_t j = xadj[col]; j < xadj[col + 1]; j++) {
+                std::size_t row = static_cast<std::size_t>(adjncy[j]);
+                if (upper and row > col) { continue; }
+                cols[cursor[row]++] = static_cast<I>(col);
+            }
+        }
+    }
+
+    template <typename I>
+    Pattern<I>
+    pattern(const metis::Nodal& nodal, Storage storage) {
+        Pattern<I> values;
+        values.rows.resize(nodal.size() + 1);
+        values.cols.resize(nonzeros(nodal, storage));
+        values.storage = storage;
+
+        csr<I>(nodal, values.rows, values.cols, storage);
+        return values;
+    }
+
+    template <typename I>
+    std::vector<I>
+    scatter(const tomos::mesh::Mesh& mesh, const Pattern<I>& pattern, parallel::Pool& pool) {
+        const std::size_t count     = mesh.elements.empty() ? 0 : mesh.elements.front().nodes.size();
+        const std::size_t stride    = entries(count, pattern.storage);
+        const bool upper            = (pattern.storage == Storage::UPPER);
+        const std::vector<I>& rows  = pattern.rows;
+        const std::vector<I>& cols  = pattern.cols;
+
+        std::vector<I> values(stride * mesh.elements.size());
+        pool.for_each(0, mesh.elements.size(), [&](std::size_t first, std::size_t last) {
+            for (std::size_t e = first; e < last; e++) {
+                const tomos::mesh::node::Numbers& nodes = mesh.elements[e].nodes;
+                if (nodes.size() != count) {
+                    throw std::domain_error("scatter requires elements of a single type");
+                }
+
+                std::size_t k = stride * e;
+                for (std::size_t i = 0; i < count; i++) {
+                    for (std::size_t j = upper ? i : 0; j < count; j++) {
+                        std::size_t row = nodes[i];
+                        std::size_t col = nodes[j];
+                        if (upper and row > col) { std::swap(row, col); }
+
+                        auto begin  = cols.begin() + rows[row];
+                        auto end    = cols.begin() + rows[row + 1];
+                        auto it     = std::lower_bound(begin, end, static_cast<I>(col));
+                        if (it == end or *it != static_cast<I>(col)) {
+                            throw std::out_of_range("element node pair missing from the pattern");
+                        }
+                        values[k++] = static_cast<I>(it - cols.begin());
+                    }
+                }
+            }
+        }, 4096);
+        return values;
+    }
+
+    template <typename I>
+    std::vector<I>
+    scatter(const tomos::mesh::Mesh& mesh, const Pattern<I>& pattern) {
+        parallel::Pool pool;
+        return scatter<I>(mesh, pattern, pool);
+    }
+
+    template <typename I>
+    void
+    multiply(
+              const Pattern<I>&         pattern
+            , std::span<const float>    values
+            , std::span<const float>    x
+            , std::span<float>          y
+            )
+    {
+        std::size_t nodes = pattern.rows.size() - 1;
+        if (values.size() != pattern.cols.size() or x.size() != nodes or y.size() != nodes) {
+            throw std::length_error("multiply operands do not match the pattern");
+        }
+
+        std::fill(y.begin(), y.end(), 0.0f);
+        for (std::size_t row = 0; row < nodes; row++) {
+            float sum = 0.0f;
+            for (I k = pattern.rows[row]; k < pattern.rows[row + 1]; k++) {
+                std::size_t col = pattern.cols[k];
+                sum += values[k] * x[col];
+                if (pattern.storage == Storage::UPPER and col != row) { y[col] += values[k] * x[row]; }
+            }
+            y[row] += sum;
+        }
+    }
+
+    template <typename I>
+    Lengths
+    lengths(const Pattern<I>& pattern) {
+        Lengths values;
+        std::size_t nodes = pattern.rows.size() - 1;
+        if (nodes == 0) { return values; }
+
+        double sum = 0.0, squares = 0.0;
+        for (std::size_t row = 0; row < nodes; row++) {
+            std::size_t length = pattern.rows[row + 1] - pattern.rows[row];
+            values.maximum  = std::max(values.maximum, length);
+            sum            += static_cast<double>(length);
+            squares        += static_cast<double>(length) * static_cast<double>(length);
+        }
+        values.mean         = sum / static_cast<double>(nodes);
+        values.deviation    = std::sqrt(std::max(0.0, squares / static_cast<double>(nodes) - values.mean * values.mean));
+        return values;
+    }
+
+    template <typename I>
+    double
+    Sell<I>::fill() const {
+        return nonzeros == 0 ? 1.0 : static_cast<double>(sources.size()) / static_cast<double>(nonzeros);
+    }
+
+    template <typename I>
+    Sell<I>
+    sell(const Pattern<I>& pattern, std::size_t chunk, std::size_t sigma) {
+        if (pattern.storage != Storage::FULL) { throw std::invalid_argument("sliced ELLPACK needs FULL storage"); }
+        if (chunk == 0 or sigma == 0) { throw std::invalid_argument("chunk and sigma must be greater than 0"); }
+
+        const std::size_t nodes = pattern.rows.size() - 1;
+        auto length = [&](I row) { return pattern.rows[row + 1] - pattern.rows[row]; };
 
-        Indices rows   = {0};
-        Indices cols   = {};
+        Sell<I> values;
+        values.chunk    = chunk;
+        values.sigma    = sigma;
+        values.nonzeros = pattern.cols.size();
+        values.rows.resize(nodes);
+        for (std::size_t row = 0; row < nodes; row++) { values.rows[row] = static_cast<I>(row); }
+
+        // stable, so equal rows keep their order and the result is deterministic
+        for (std::size_t first = 0; first < nodes; first += sigma) {
+            auto begin  = values.rows.begin() + first;
+            auto end    = values.rows.begin() + std::min(nodes, first + sigma);
+            std::stable_sort(begin, end, [&](I a, I b) { return length(a) > length(b); });
+        }
 
-        for (const auto& [key, neighbours] : adjacency) {
-            cols.push_back(key);
-            cols.insert(cols.end(), neighbours.begin(), neighbours.end());
-            rows.push_back(1 + neighbours.size() + rows.back());
+        std::size_t slices = (nodes + chunk - 1) / chunk;
+        values.slices = {0};
+        for (std::size_t slice = 0; slice < slices; slice++) {
+            I width = 0;
+            for (std::size_t slot = slice * chunk; slot < std::min(nodes, (slice + 1) * chunk); slot++) {
+                width = std::max(width, length(values.rows[slot]));
+            }
+            values.widths.push_back(width);
+            values.slices.push_back(static_cast<I>(values.slices.back() + width * chunk));
         }
 
-        return {cols, rows};
+        values.cols.assign(values.slices.back(), 0);
+        values.sources.assign(values.slices.back(), Sell<I>::PADDING);
+        for (std::size_t slot = 0; slot < nodes; slot++) {
+            std::size_t slice   = slot / chunk;
+            std::size_t lane    = slot % chunk;
+            I row               = values.rows[slot];
+            for (I j = 0; j < length(row); j++) {
+                std::size_t k       = values.slices[slice] + j * chunk + lane;
+                values.cols[k]      = pattern.cols[pattern.rows[row] + j];
+                values.sources[k]   = pattern.rows[row] + j;
+            }
+        }
+        return values;
     }
 
+    template <typename I>
+    std::vector<float>
+    pack(const Sell<I>& sell, std::span<const float> values) {
+        if (values.size() != sell.nonzeros) {
+            throw std::length_error("values do not match the pattern");
+        }
+
+        std::vector<float> packed(sell.sources.size(), 0.0f);
+        for (std::size_t k = 0; k < packed.size(); k++) {
+            if (sell.sources[k] != Sell<I>::PADDING) { packed[k] = values[sell.sources[k]]; }
+        }
+        return packed;
+    }
+
+    template <typename I>
+    void
+    multiply(
+              const Sell<I>&            sell
+            , std::span<const float>    values
+            , std::span<const float>    x
+            , std::span<float>          y
+            )
+    {
+        std::size_t nodes = sell.rows.size();
+        if (values.size() != sell.cols.size() or x.size() != nodes or y.size() != nodes) {
+            throw std::length_error("multiply operands do not match the pattern");
+        }
+
+        for (std::size_t slot = 0; slot < nodes; slot++) {
+            std::size_t slice   = slot / sell.chunk;
+            std::size_t lane    = slot % sell.chunk;
+
+            float sum = 0.0f;
+            for (I j = 0; j < sell.widths[slice]; j++) {
+                std::size_t k = sell.slices[slice] + j * sell.chunk + lane;
+                sum += values[k] * x[sell.cols[k]];
+            }
+            y[sell.rows[slot]] = sum;
+        }
+    }
+
+    Format
+    select(const Lengths& lengths, double fill, std::size_t warp) {
+        if (lengths.mean >= static_cast<double>(warp) / 2.0) { return Format::VECTOR; }
+        if (fill <= 1.5) { return Format::SELL; }
+        return Format::SCALAR;
+    }
+
+    std::pair<Indices, Indices>
+    csr(const metis::Nodal& nodal) {
+        Pattern<std::uint64_t> values = pattern<std::uint64_t>(nodal);
+        return {
+              Indices(values.cols.begin(), values.cols.end())
+            , Indices(values.rows.begin(), values.rows.end())
+        };
+    }
+
+    template void csr<std::uint32_t>(const metis::Nodal&, std::span<std::uint32_t>, std::span<std::uint32_t>, Storage);
+    template void csr<std::uint64_t>(const metis::Nodal&, std::span<std::uint64_t>, std::span<std::uint64_t>, Storage);
+
+    template Pattern<std::uint32_t> pattern<std::uint32_t>(const metis::Nodal&, Storage);
+    template Pattern<std::uint64_t> pattern<std::uint64_t>(const metis::Nodal&, Storage);
+
+    template std::vector<std::uint32_t> scatter<std::uint32_t>(const tomos::mesh::Mesh&, const Pattern<std::uint32_t>&, parallel::Pool&);
+    template std::vector<std::uint64_t> scatter<std::uint64_t>(const tomos::mesh::Mesh&, const Pattern<std::uint64_t>&, parallel::Pool&);
+
+    template std::vector<std::uint32_t> scatter<std::uint32_t>(const tomos::mesh::Mesh&, const Pattern<std::uint32_t>&);
+    template std::vector<std::uint64_t> scatter<std::uint64_t>(const tomos::mesh::Mesh&, const Pattern<std::uint64_t>&);
+
+    template void multiply<std::uint32_t>(const Pattern<std::uint32_t>&, std::span<const float>, std::span<const float>, std::span<float>);
+    template void multiply<std::uint64_t>(const Pattern<std::uint64_t>&, std::span<const float>, std::span<const float>, std::span<float>);
+
+    template Lengths lengths<std::uint32_t>(const Pattern<std::uint32_t>&);
+    template Lengths lengths<std::uint64_t>(const Pattern<std::uint64_t>&);
+
+    template struct Sell<std::uint32_t>;
+    template struct Sell<std::uint64_t>;
+
+    template Sell<std::uint32_t> sell<std::uint32_t>(const Pattern<std::uint32_t>&, std::size_t, std::size_t);
+    template Sell<std::uint64_t> sell<std::uint64_t>(const Pattern<std::uint64_t>&, std::size_t, std::size_t);
+
+    template std::vector<float> pack<std::uint32_t>(const Sell<std::uint32_t>&, std::span<const float>);
+    template std::vector<float> pack<std::uint64_t>(const Sell<std::uint64_t>&, std::span<const float>);
+
+    template void multiply<std::uint32_t>(const Sell<std::uint32_t>&, std::span<const float>, std::span<const float>, std::span<float>);
+    template void multiply<std::uint64_t>(const Sell<std::uint64_t>&, std::span<const float>, std::span<const float>, std::span<float>);
+
     std::map<Coordinate, Index>
     coo(const metis::Nodal& nodal) {
-        metis::Adjacency adjacency = nodal.adjacency();
-        std::size_t count = 0;
+        Pattern<std::uint64_t> values = pattern<std::uint64_t>(nodal);
 
         std::map<Coordinate, Index> ps;
-        for (const auto& [key, neighbours] : adjacency) {
-            std::vector<metis::Index> xs{key};
-            xs.insert(xs.end(), neighbours.begin(), neighbours.end());
-
-            for (std::size_t i = 0; i < xs.size(); i++) {
-                auto [_, inserted] =  ps.insert({{key, xs[i]}, count});
-                if (inserted) { count++; }
+        for (std::size_t row = 0; row + 1 < values.rows.size(); row++) {
+            for (std::uint64_t k = values.rows[row]; k < values.rows[row + 1]; k++) {
+                ps.insert(ps.end(), {{row, values.cols[k]}, k});
             }
         }
         return ps;
@@ -0,0 +1,69 @@
+#include "tomos/tomos-topology.hpp"
+
+#include "tomos/tomos-partition.hpp"
+
+namespace tomos {
+    Topology::Topology(const tomos::mesh::Mesh& mesh)
+        : mesh_(mesh)
+    {}
+
+    const metis::Nodal&
+    Topology::nodal() {
+        if (not nodal_) { nodal_.emplace(mesh_); }
+        return *nodal_;
+    }
+
+    metis::Dual&
+    Topology::dual(metis::Common common) {
+        auto it = duals_.find(common);
+        if (it == duals_.end()) { it = duals_.try_emplace(common, mesh_, common).first; }
+        return it->second;
+    }
+
+    const Topology::Pattern&
+    Topology::pattern(sparse::Storage storage) {
+        auto it = patterns_.find(storage);
+        if (it == patterns_.end()) {
+            it = patterns_.emplace(storage, sparse::pattern<Index>(this->nodal(), storage)).first;
+        }
+        return it->second;
+    }
+
+    const std::vector<Topology::Index>&
+    Topology::scatter(sparse::Storage storage) {
+        auto it = scatters_.find(storage);
+        if (it == scatters_.end()) {
+            it = scatters_.emplace(storage, sparse::scatter(mesh_, this->pattern(storage))).first;
+        }
+        return it->second;
+    }
+
+    const color::Colors&
+    Topology::colors(metis::Common common) {
+        auto it = colors_.find(common);
+        if (it == colors_.end()) {
+            // NODE colors come from the parallel incidence pass, the dense NODE dual is not built for them
+            color::Colors colors = (common == metis::Common::NODE) ? color::incidence(mesh_) : color::build(this->dual(common));
+            it = colors_.emplace(common, std::move(colors)).first;
+        }
+        return it->second;
+    }
+
+    const metis::Partitions&
+    Topology::partitions(std::size_t count) {
+        auto it = partitions_.find(count);
+        if (it == partitions_.end()) {
+            it = partitions_.emplace(count, this->dual(metis::Common::EDGE).partition(count)).first;
+        }
+        return it->second;
+    }
+
+    std::size_t
+    Topology::optimal(std::size_t limit) {
+        auto it = optimal_.find(limit);
+        if (it == optimal_.end()) {
+            it = optimal_.emplace(limit, partition::optimal(this->dual(metis::Common::EDGE), mesh_, limit)).first;
+        }
+        return it->second;
+    }
+} // namespace tomos
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include <tomos/tomos-cache.hpp>
+
+TEST(Cache, Hash) {
+    tomos::cache::Key lhs = tomos::cache::hash({"ab", "c"});
+    tomos::cache::Key rhs = tomos::cache::hash({"a", "bc"});
+
+    EXPECT_NE(lhs, rhs);
+    EXPECT_EQ(lhs, tomos::cache::hash({"ab", "c"}));
+}
+
+TEST(Cache, Roundtrip) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "tomos-cache-test";
+    std::filesystem::remove_all(directory);
+
+    tomos::cache::Key key           = tomos::cache::hash({"kernel", "-DTOMOS"});
+    tomos::cache::Binary expected   = {0x7f, 'E', 'L', 'F', 0x00, 0x01};
+
+    EXPECT_FALSE(tomos::cache::load(directory, key).has_value());
+    tomos::cache::store(directory, key, expected);
+
+    std::optional<tomos::cache::Binary> actual = tomos::cache::load(directory, key);
+    ASSERT_TRUE(actual.has_value());
+    ASSERT_EQ(actual->size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); i++) { EXPECT_EQ((*actual)[i], expected[i]); }
+
+    EXPECT_FALSE(tomos::cache::load(directory, key + 1).has_value());
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Cache, Disabled) {
+    tomos::cache::Key key = tomos::cache::hash({"kernel"});
+    tomos::cache::store({}, key, {0x01});
+    EXPECT_FALSE(tomos::cache::load({}, key).has_value());
+}
+
+int
+main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
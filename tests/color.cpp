@@ -0,0 +1,116 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <tomos/tomos.hpp>
+#include <tomos/tomos-mesh.hpp>
+
+// n x n square grid of 2 n^2 triangles
+tomos::mesh::Mesh
+grid(std::size_t n) {
+    tomos::mesh::Mesh mesh;
+    for (std::size_t j = 0; j <= n; j++) {
+        for (std::size_t i = 0; i <= n; i++) {
+            mesh.nodes.push_back({{static_cast<float>(i), static_cast<float>(j), 0.0f, 0.0f}});
+        }
+    }
+    auto id = [&](std::size_t i, std::size_t j) { return static_cast<tomos::mesh::node::Number>(j * (n + 1) + i); };
+    for (std::size_t j = 0; j < n; j++) {
+        for (std::size_t i = 0; i < n; i++) {
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j), id(i + 1, j + 1)}});
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j + 1), id(i, j + 1)}});
+        }
+    }
+    return mesh;
+}
+
+TEST(Color, Valid) {
+    tomos::mesh::Mesh mesh = grid(16);
+    tomos::metis::Dual dual(mesh, tomos::metis::Common::NODE);
+
+    for (bool balance : {false, true}) {
+        tomos::color::Colors colors = tomos::color::build(dual, {4, balance});
+        ASSERT_EQ(colors.color.size(), mesh.elements.size());
+        ASSERT_EQ(colors.order.size(), mesh.elements.size());
+
+        // no two elements sharing a node have the same color
+        for (std::size_t v = 0; v < dual.size(); v++) {
+            for (const idx_t& u : dual.neighbours(v)) { EXPECT_NE(colors.color[v], colors.color[u]); }
+        }
+        // greedy never needs more than the largest degree plus one
+        std::size_t degree = 0;
+        for (std::size_t v = 0; v < dual.size(); v++) { degree = std::max(degree, dual.degree(v)); }
+        EXPECT_LE(colors.count(), degree + 1);
+    }
+}
+
+TEST(Color, Deterministic) {
+    tomos::mesh::Mesh mesh = grid(16);
+    tomos::metis::Dual dual(mesh, tomos::metis::Common::NODE);
+
+    EXPECT_EQ(tomos::color::build(dual, {1, true}), tomos::color::build(dual, {8, true}));
+    EXPECT_EQ(tomos::color::build(dual, {1, false}), tomos::color::build(dual, {3, false}));
+}
+
+TEST(Color, Balance) {
+    tomos::mesh::Mesh mesh = grid(16);
+    tomos::metis::Dual dual(mesh, tomos::metis::Common::NODE);
+
+    tomos::color::Colors raw        = tomos::color::build(dual, {2, false});
+    tomos::color::Colors balanced   = tomos::color::build(dual, {2, true});
+
+    // same number of classes, no wider spread
+    EXPECT_EQ(balanced.count(), raw.count());
+    EXPECT_LE(balanced.largest() - balanced.smallest(), raw.largest() - raw.smallest());
+}
+
+TEST(Color, Incidence) {
+    tomos::mesh::Mesh mesh = grid(16);
+    tomos::metis::Dual dual(mesh, tomos::metis::Common::NODE);
+
+    for (bool balance : {false, true}) {
+        tomos::color::Colors colors = tomos::color::incidence(mesh, {1, balance});
+        ASSERT_EQ(colors.color.size(), mesh.elements.size());
+
+        for (std::size_t v = 0; v < dual.size(); v++) {
+            for (const idx_t& u : dual.neighbours(v)) { EXPECT_NE(colors.color[v], colors.color[u]); }
+        }
+        EXPECT_EQ(colors, tomos::color::build(mesh, tomos::metis::Common::NODE, {1, balance}));
+        EXPECT_EQ(colors, tomos::color::incidence(mesh, {4, balance}));
+    }
+
+    // one node shared by 70 elements needs more colors than one mask word holds
+    tomos::mesh::Mesh fan;
+    fan.nodes.push_back({{0.0f, 0.0f, 0.0f, 0.0f}});
+    for (std::size_t i = 0; i < 71; i++) {
+        float angle = 2.0f * 3.14159265f * static_cast<float>(i) / 71.0f;
+        fan.nodes.push_back({{std::cos(angle), std::sin(angle), 0.0f, 0.0f}});
+    }
+    for (std::size_t i = 0; i < 70; i++) {
+        fan.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {
+              0
+            , static_cast<tomos::mesh::node::Number>(i + 1)
+            , static_cast<tomos::mesh::node::Number>(i + 2)
+        }});
+    }
+    tomos::color::Colors wide = tomos::color::incidence(fan);
+    EXPECT_EQ(wide.count(), 70);
+    EXPECT_EQ(wide.smallest(), 1);
+}
+
+TEST(Color, Classes) {
+    tomos::color::Colors colors = tomos::color::classes({2, 0, 1, 0, 2, 0});
+
+    EXPECT_EQ(colors.count(), 3);
+    EXPECT_EQ(colors.order, std::vector<std::uint32_t>({1, 3, 5, 2, 0, 4}));
+    EXPECT_EQ(colors.offsets, std::vector<std::size_t>({0, 3, 4, 6}));
+    EXPECT_EQ(colors.size(2), 2);
+    EXPECT_EQ(colors.smallest(), 1);
+    EXPECT_EQ(colors.largest(), 3);
+
+    EXPECT_EQ(tomos::color::classes({}).count(), 0);
+}
+
+int
+main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
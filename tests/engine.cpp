@@ -1,10 +1,10 @@
 #include <boost/spirit/include/qi.hpp>
+#include <cstdlib>
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <tomos/tomos.hpp>
 #include <tomos/tomos-mesh.hpp>
 
-const std::filesystem::path KERNEL = {"./shaders/tomos.kernel"};
-
 TEST(GPU, Area) {
     tomos::mesh::Mesh mesh = {
           tomos::mesh::Nodes{
@@ -22,7 +22,7 @@ TEST(GPU, Area) {
             , {tomos::mesh::element::Type::TRIANGLE3, {0, 5, 6}}
         }
     };
-    tomos::Engine engine(KERNEL, mesh);
+    tomos::Engine engine(mesh);
     std::vector<float> expected = {0.5, 2.0, 4.5};
     std::vector<float> actual   = engine.area();
 
@@ -47,7 +47,7 @@ TEST(GPU, Centroid) {
             , {tomos::mesh::element::Type::TRIANGLE3, {0, 5, 6}}
         }
     };
-    tomos::Engine engine(KERNEL, mesh);
+    tomos::Engine engine(mesh);
     tomos::mesh::Nodes expected = {
           {{0.666666, 0.333333, 0.000000}}
         , {{1.333333, 0.666666, 0.000000}}
@@ -81,7 +81,7 @@ TEST(GPU, Normal) {
             , {tomos::mesh::element::Type::TRIANGLE3, {0, 5, 6}}
         }
     };
-    tomos::Engine engine(KERNEL, mesh);
+    tomos::Engine engine(mesh);
     tomos::mesh::Nodes expected = {
           {{0.0f, 0.0f, 1.0f}}
         , {{0.0f, 0.0f, 4.0f}}
@@ -98,6 +98,111 @@ TEST(GPU, Normal) {
 }
 
 
+TEST(GPU, Geometry) {
+    tomos::mesh::Mesh mesh = {
+         tomos::mesh::Nodes{
+              {{0.0f, 0.0f, 0.0f}}
+            , {{1.0f, 0.0f, 0.0f}}
+            , {{1.0f, 1.0f, 0.0f}}
+            , {{2.0f, 0.0f, 0.0f}}
+            , {{2.0f, 2.0f, 0.0f}}
+            , {{3.0f, 0.0f, 0.0f}}
+            , {{3.0f, 3.0f, 0.0f}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 3, 4}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 5, 6}}
+        }
+    };
+    tomos::Engine engine(mesh);
+
+    std::vector<float> area                 = engine.area();
+    std::vector<tomos::mesh::Node> centroid = engine.centroid();
+    std::vector<tomos::mesh::Node> normal   = engine.normal();
+    tomos::Geometry actual                  = engine.geometry(true);
+
+    ASSERT_EQ(actual.area.size(), area.size());
+    ASSERT_EQ(actual.aspect.size(), area.size());
+    for (std::size_t i = 0; i < area.size(); i++) {
+        EXPECT_FLOAT_EQ(actual.area[i], area[i]);
+        for (std::size_t j = 0; j < 3; j++) {
+            EXPECT_FLOAT_EQ(actual.centroid[i].s[j], centroid[i].s[j]);
+            EXPECT_FLOAT_EQ(actual.normal[i].s[j], normal[i].s[j]);
+        }
+        // right isosceles triangles, (1 + sqrt(2)) / 2
+        EXPECT_NEAR(actual.aspect[i], 1.2071068f, 1e-4);
+    }
+    EXPECT_TRUE(engine.geometry().aspect.empty());
+}
+
+TEST(GPU, Async) {
+    tomos::mesh::Mesh mesh = {
+         tomos::mesh::Nodes{
+              {{0.0f, 0.0f, 0.0f}}
+            , {{1.0f, 0.0f, 0.0f}}
+            , {{1.0f, 1.0f, 0.0f}}
+            , {{2.0f, 0.0f, 0.0f}}
+            , {{2.0f, 2.0f, 0.0f}}
+            , {{3.0f, 0.0f, 0.0f}}
+            , {{3.0f, 3.0f, 0.0f}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 3, 4}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 5, 6}}
+        }
+    };
+    tomos::Engine engine(mesh);
+
+    tomos::Future<float> area               = engine.area_async();
+    tomos::Future<tomos::mesh::Node> normal = engine.normal_async({area.event()});
+
+    std::vector<float> expected = {1.0, 4.0, 9.0};
+    std::vector<tomos::mesh::Node> actual   = normal.get();
+    std::vector<float> areas                = area.get();
+
+    ASSERT_EQ(actual.size(), expected.size());
+    ASSERT_EQ(areas.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i].s[2], expected[i]);
+        EXPECT_FLOAT_EQ(areas[i], expected[i] / 2.0f);
+    }
+}
+
+
+TEST(GPU, Cache) {
+    tomos::mesh::Mesh mesh = {
+          tomos::mesh::Nodes{
+              {{0.0f, 0.0f, 0.0f}}
+            , {{1.0f, 0.0f, 0.0f}}
+            , {{1.0f, 1.0f, 0.0f}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+        }
+    };
+    // a fresh directory, so neither the user's cache nor earlier runs are involved
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "tomos-engine-cache-test";
+    std::filesystem::remove_all(directory);
+
+    const char * previous = std::getenv("TOMOS_CACHE");
+    std::optional<std::string> saved = previous ? std::optional<std::string>(previous) : std::nullopt;
+    setenv("TOMOS_CACHE", directory.c_str(), 1);
+
+    {
+        tomos::Engine fst(mesh);
+        tomos::Engine snd(mesh);
+
+        EXPECT_EQ(fst.cache(), tomos::cache::Status::MISS);
+        EXPECT_EQ(snd.cache(), tomos::cache::Status::HIT);
+        EXPECT_FLOAT_EQ(snd.area()[0], 0.5f);
+    }
+
+    if (saved) { setenv("TOMOS_CACHE", saved->c_str(), 1); } else { unsetenv("TOMOS_CACHE"); }
+    std::filesystem::remove_all(directory);
+}
+
 TEST(Stiffness, Oracle) {
     const tomos::mesh::Mesh mesh = {
         tomos::mesh::Nodes{
@@ -109,17 +214,17 @@ TEST(Stiffness, Oracle) {
             {{tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}}
         }
     };
-    tomos::Engine engine(KERNEL, mesh);
+    tomos::Engine engine(mesh);
     std::vector<float> expected = {
            0.73267143964767456
         , -0.30705833435058594
         , -0.42561310529708862
-        ,  0.46990343928337097
         , -0.30705833435058594
+        ,  0.46990343928337097
         , -0.16284510493278503
-        ,  0.58845824003219604
         , -0.42561310529708862
         , -0.16284510493278503
+        ,  0.58845824003219604
     };
     std::vector<float> actual   = engine.color();
     ASSERT_EQ(actual.size(), expected.size());
@@ -142,22 +247,22 @@ TEST(Stiffness, Square) {
             , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
         }
     };
-    tomos::Engine engine(KERNEL, mesh);
+    tomos::Engine engine(mesh);
     std::vector<float> expected = {
            1.0  // (1, 1) -  0
         , -0.5  // (1, 2) -  1
         ,  0.0  // (1, 3) -  2
         , -0.5  // (1, 4) -  3
-        ,  1.0  // (2, 2) -  4
-        , -0.5  // (2, 1) -  5
+        , -0.5  // (2, 1) -  4
+        ,  1.0  // (2, 2) -  5
         , -0.5  // (2, 3) -  6
-        ,  1.0  // (3, 3) -  7
-        ,  0.0  // (3, 1) -  8
-        , -0.5  // (3, 2) -  9
+        ,  0.0  // (3, 1) -  7
+        , -0.5  // (3, 2) -  8
+        ,  1.0  // (3, 3) -  9
         , -0.5  // (3, 4) - 10
-        ,  1.0  // (4, 4) - 11
-        , -0.5  // (4, 1) - 12
-        , -0.5  // (4, 3) - 13
+        , -0.5  // (4, 1) - 11
+        , -0.5  // (4, 3) - 12
+        ,  1.0  // (4, 4) - 13
     };
     std::vector<float> actual = engine.color();
     ASSERT_EQ(actual.size(), expected.size());
@@ -168,6 +273,363 @@ TEST(Stiffness, Square) {
 }
 
 
+TEST(Stiffness, Resident) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    tomos::Engine engine(mesh);
+
+    std::vector<float> expected         = engine.color();
+    tomos::Handle<float> area           = engine.area_device();
+    tomos::Handle<float> stiffness      = engine.color_device(area);
+    std::vector<float> actual           = engine.download(stiffness).get();
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], expected[i]);
+    }
+}
+
+
+TEST(Stiffness, Plan) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    tomos::Engine engine(mesh);
+
+    const tomos::Plan& plan = engine.plan();
+    EXPECT_EQ(plan.nonzeros, 14);
+    EXPECT_EQ(plan.offsets.front(), 0);
+    EXPECT_EQ(plan.offsets.back(), mesh.elements.size());
+
+    // reassembling reuses the plan and must not accumulate into previous values
+    std::vector<float> expected = engine.color();
+    std::vector<float> actual   = engine.color();
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], expected[i]);
+    }
+}
+
+TEST(Stiffness, Conductivity) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    tomos::Engine engine(mesh);
+    std::vector<float> homogeneous = engine.color();
+
+    std::vector<float> ones     = {1.0f, 1.0f};
+    std::vector<float> actual   = engine.stiffness(ones);
+    ASSERT_EQ(actual.size(), homogeneous.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], homogeneous[i]);
+    }
+
+    std::vector<float> twos = {2.0f, 2.0f};
+    actual                  = engine.stiffness(twos);
+    ASSERT_EQ(actual.size(), homogeneous.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], 2.0f * homogeneous[i]);
+    }
+
+    std::vector<float> invalid = {1.0f};
+    EXPECT_THROW(engine.assemble(invalid), std::invalid_argument);
+}
+
+TEST(Stiffness, Strategy) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    tomos::Engine engine(mesh);
+    std::vector<float> conductivity = {1.0f, 3.0f};
+    std::vector<float> expected     = engine.stiffness(conductivity);
+
+    for (tomos::Strategy strategy : {tomos::Strategy::ATOMIC, tomos::Strategy::REDUCE, tomos::Strategy::TILED}) {
+        engine.strategy(strategy);
+        std::vector<float> actual = engine.stiffness(conductivity);
+
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t i = 0; i < actual.size(); i++) {
+            EXPECT_FLOAT_EQ(actual[i], expected[i]);
+        }
+    }
+}
+
+TEST(Stiffness, Empty) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    cl::Device device = tomos::device::select(tomos::device::Policy{}).front();
+    tomos::Engine engine(mesh, device, tomos::partition::Indices{});
+
+    // no element assembled, every strategy leaves the pattern at zero
+    for (tomos::Strategy strategy : {tomos::Strategy::COLOR, tomos::Strategy::ATOMIC, tomos::Strategy::REDUCE, tomos::Strategy::TILED}) {
+        engine.strategy(strategy);
+        std::vector<float> actual = engine.color();
+
+        ASSERT_EQ(actual.size(), 14);
+        for (const float& value : actual) { EXPECT_EQ(value, 0.0f); }
+    }
+}
+
+TEST(Stiffness, Cluster) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    tomos::Engine engine(mesh);
+    tomos::Cluster cluster(mesh);
+
+    std::vector<float> expected = engine.color();
+    std::vector<float> actual   = cluster.color();
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], expected[i]);
+    }
+}
+
+TEST(Stiffness, Symmetric) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    tomos::kernel::Options options;
+    options.symmetric = true;
+
+    tomos::Engine engine(mesh, tomos::device::Policy{}, options);
+    EXPECT_EQ(engine.storage(), tomos::sparse::Storage::UPPER);
+
+    // (1, 1), (1, 2), (1, 3), (1, 4), (2, 2), (2, 3), (3, 3), (3, 4), (4, 4)
+    std::vector<float> expected = {1.0, -0.5, 0.0, -0.5, 1.0, -0.5, 1.0, -0.5, 1.0};
+    for (tomos::Strategy strategy : {tomos::Strategy::COLOR, tomos::Strategy::ATOMIC, tomos::Strategy::REDUCE, tomos::Strategy::TILED}) {
+        engine.strategy(strategy);
+        std::vector<float> actual = engine.color();
+
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t i = 0; i < actual.size(); i++) {
+            EXPECT_FLOAT_EQ(actual[i], expected[i]);
+        }
+    }
+}
+
+TEST(Stiffness, Native) {
+    const std::size_t n = 12;
+    tomos::mesh::Mesh mesh;
+    for (std::size_t j = 0; j <= n; j++) {
+        for (std::size_t i = 0; i <= n; i++) {
+            mesh.nodes.push_back({{static_cast<float>(i), static_cast<float>(j), 0.0f, 0.0f}});
+        }
+    }
+    auto id = [&](std::size_t i, std::size_t j) { return static_cast<tomos::mesh::node::Number>(j * (n + 1) + i); };
+    for (std::size_t j = 0; j < n; j++) {
+        for (std::size_t i = 0; i < n; i++) {
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j), id(i + 1, j + 1)}});
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j + 1), id(i, j + 1)}});
+        }
+    }
+    std::vector<float> conductivity(mesh.elements.size());
+    for (std::size_t i = 0; i < conductivity.size(); i++) { conductivity[i] = 1.0f + static_cast<float>(i % 5); }
+
+    tomos::kernel::Options options;
+    options.thickness   = 0.25f;
+    options.resistivity = 2.0f;
+
+    // both backends share the topology, so the values index the same pattern
+    auto topology = std::make_shared<tomos::Topology>(mesh);
+    for (bool symmetric : {false, true}) {
+        options.symmetric = symmetric;
+        tomos::Engine engine(topology, tomos::device::Policy{}, options);
+        tomos::Native native(topology, 2, options);
+
+        std::vector<float> areas    = engine.area();
+        std::vector<float> expected = native.area();
+        ASSERT_EQ(areas.size(), expected.size());
+        for (std::size_t i = 0; i < areas.size(); i++) { EXPECT_FLOAT_EQ(areas[i], expected[i]); }
+
+        // per-element conductivity, then the constant resistivity
+        for (bool homogeneous : {false, true}) {
+            std::vector<float> actual   = homogeneous ? engine.color() : engine.stiffness(conductivity);
+            std::vector<float> values   = homogeneous ? native.color() : native.stiffness(conductivity);
+
+            ASSERT_EQ(actual.size(), values.size());
+            for (std::size_t i = 0; i < actual.size(); i++) {
+                EXPECT_NEAR(actual[i], values[i], 1e-4f * std::max(1.0f, std::abs(values[i])));
+            }
+        }
+    }
+}
+
+TEST(Stiffness, Tiled) {
+    // 16 x 16 grid, enough elements for several work-groups on small local memories
+    const std::size_t n = 16;
+    tomos::mesh::Mesh mesh;
+    for (std::size_t j = 0; j <= n; j++) {
+        for (std::size_t i = 0; i <= n; i++) {
+            mesh.nodes.push_back({{static_cast<float>(i), static_cast<float>(j), 0.0f, 0.0f}});
+        }
+    }
+    auto id = [&](std::size_t i, std::size_t j) { return static_cast<tomos::mesh::node::Number>(j * (n + 1) + i); };
+    for (std::size_t j = 0; j < n; j++) {
+        for (std::size_t i = 0; i < n; i++) {
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j), id(i + 1, j + 1)}});
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j + 1), id(i, j + 1)}});
+        }
+    }
+    std::vector<float> conductivity(mesh.elements.size());
+    for (std::size_t i = 0; i < conductivity.size(); i++) { conductivity[i] = 1.0f + static_cast<float>(i % 7); }
+
+    tomos::Engine engine(mesh);
+    std::vector<float> expected = engine.stiffness(conductivity);
+
+    // the whole grid fits one tile, a small node limit forces several
+    engine.strategy(tomos::Strategy::TILED);
+    for (std::size_t limit : {std::size_t{65536}, std::size_t{32}}) {
+        engine.tile(limit);
+        std::vector<float> actual = engine.stiffness(conductivity);
+        if (limit == 32) { EXPECT_GT(engine.plan().offsets.size() - 1, 1); }
+
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t i = 0; i < actual.size(); i++) {
+            EXPECT_NEAR(actual[i], expected[i], 1e-4f * std::max(1.0f, std::abs(expected[i])));
+        }
+    }
+}
+
+TEST(Multiply, Formats) {
+    const tomos::mesh::Mesh mesh = {
+        tomos::mesh::Nodes{
+              {{0.0, 0.0, 0.0}}
+            , {{1.0, 0.0, 0.0}}
+            , {{1.0, 1.0, 0.0}}
+            , {{0.0, 1.0, 0.0}}
+        }
+        , tomos::mesh::Elements{
+              {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+            , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+        }
+    };
+    tomos::Engine engine(mesh);
+    tomos::Handle<float> values = engine.color_device();
+
+    std::vector<float> stiffness    = engine.download(values).get();
+    std::vector<float> x            = {1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<float> expected(x.size());
+    tomos::sparse::multiply(engine.topology()->pattern(), stiffness, x, expected);
+
+    // automatic choice first, then every format explicitly
+    for (std::optional<tomos::sparse::Format> format : std::vector<std::optional<tomos::sparse::Format>>{
+              std::nullopt
+            , tomos::sparse::Format::SCALAR
+            , tomos::sparse::Format::VECTOR
+            , tomos::sparse::Format::SELL
+            })
+    {
+        if (format) { engine.format(*format); }
+        std::vector<float> actual = engine.multiply(values, x);
+
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t i = 0; i < actual.size(); i++) {
+            EXPECT_FLOAT_EQ(actual[i], expected[i]);
+        }
+    }
+
+    std::vector<float> invalid = {1.0f};
+    EXPECT_THROW(engine.multiply(values, invalid), std::invalid_argument);
+
+    // a new assembly into the same buffer is packed again for SELL
+    std::vector<float> conductivity = {1.0f, 3.0f};
+    tomos::Handle<float> reassembled = engine.assemble(conductivity);
+    std::vector<float> weighted     = engine.download(reassembled).get();
+    std::vector<float> product(x.size());
+    tomos::sparse::multiply(engine.topology()->pattern(), weighted, x, product);
+
+    std::vector<float> sliced = engine.multiply(reassembled, x);
+    ASSERT_EQ(sliced.size(), product.size());
+    for (std::size_t i = 0; i < sliced.size(); i++) {
+        EXPECT_FLOAT_EQ(sliced[i], product[i]);
+    }
+
+    // the upper triangle is mirrored on the device, SCALAR only
+    tomos::kernel::Options options;
+    options.symmetric = true;
+
+    tomos::Engine symmetric(mesh, tomos::device::Policy{}, options);
+    tomos::Handle<float> upper  = symmetric.color_device();
+    std::vector<float> actual   = symmetric.multiply(upper, x);
+    EXPECT_EQ(symmetric.format(), tomos::sparse::Format::SCALAR);
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], expected[i]);
+    }
+
+    symmetric.format(tomos::sparse::Format::SELL);
+    EXPECT_THROW(symmetric.multiply(upper, x), std::domain_error);
+}
+
 int
 main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
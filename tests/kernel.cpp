@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include <tomos/tomos-kernel.hpp>
+
+TEST(Kernel, Embedded) {
+    const std::string& source = tomos::kernel::embedded();
+
+    EXPECT_NE(source.find("kernel void\nstiffness("), std::string::npos);
+    EXPECT_EQ(source, tomos::kernel::source({}));
+}
+
+TEST(Kernel, Build) {
+    tomos::kernel::Options options;
+    EXPECT_EQ(tomos::kernel::build(options), "-DTOMOS_NODES=3 -DTOMOS_THICKNESS=0x1p+0f -DTOMOS_RESISTIVITY=0x1p+0f");
+
+    options.thickness   = 0.5f;
+    options.resistivity = std::nullopt;
+    EXPECT_EQ(tomos::kernel::build(options), "-DTOMOS_NODES=3 -DTOMOS_THICKNESS=0x1p-1f");
+
+    options.symmetric   = true;
+    EXPECT_EQ(tomos::kernel::build(options), "-DTOMOS_NODES=3 -DTOMOS_THICKNESS=0x1p-1f -DTOMOS_SYMMETRIC");
+
+    options.nodes = 4;
+    EXPECT_THROW(tomos::kernel::build(options), std::domain_error);
+}
+
+int
+main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -115,6 +115,38 @@ TEST(Nodal, Simple) {
     }
 }
 
+TEST(Graph, Views) {
+    tomos::metis::Nodal nodal(MESH);
+    tomos::metis::Adjacency adjacency = nodal.adjacency();
+
+    ASSERT_EQ(nodal.size(), MESH.nodes.size());
+    ASSERT_EQ(nodal.offsets().size(), MESH.nodes.size() + 1);
+    EXPECT_EQ(nodal.neighbours().size(), 32);
+
+    for (std::size_t k = 0; k < nodal.size(); k++) {
+        std::span<const idx_t> vs = nodal.neighbours(k);
+        ASSERT_EQ(vs.size(), nodal.degree(k));
+        ASSERT_EQ(vs.size(), adjacency[k].size());
+        for (std::size_t i = 0; i < vs.size(); i++) { EXPECT_EQ(static_cast<tomos::metis::Index>(vs[i]), adjacency[k][i]); }
+    }
+}
+
+TEST(Graph, Move) {
+    tomos::metis::Dual dual(MESH, tomos::metis::Common::EDGE);
+    const idx_t * data = dual.neighbours().data();
+
+    tomos::metis::Dual moved(std::move(dual));
+    EXPECT_EQ(moved.neighbours().data(), data);
+    EXPECT_EQ(moved.size(), MESH.elements.size());
+    EXPECT_EQ(moved.neighbours(0).size(), 2);
+
+    std::vector<tomos::metis::Dual> duals;
+    duals.push_back(std::move(moved));
+    duals.emplace_back(MESH, tomos::metis::Common::NODE);
+    EXPECT_EQ(duals[0].neighbours().data(), data);
+    EXPECT_EQ(duals[1].neighbours(0).size(), 7);
+}
+
 TEST(Partition, Edge2) {
     tomos::metis::Dual dual(MESH, tomos::metis::Common::EDGE);
     tomos::metis::Partitions actual     = dual.partition(2);
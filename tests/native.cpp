@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <tomos/tomos.hpp>
+#include <tomos/tomos-mesh.hpp>
+
+const tomos::mesh::Mesh TRIANGLES = {
+      tomos::mesh::Nodes{
+          {{0.0f, 0.0f, 0.0f}}
+        , {{1.0f, 0.0f, 0.0f}}
+        , {{1.0f, 1.0f, 0.0f}}
+        , {{2.0f, 0.0f, 0.0f}}
+        , {{2.0f, 2.0f, 0.0f}}
+        , {{3.0f, 0.0f, 0.0f}}
+        , {{3.0f, 3.0f, 0.0f}}
+    }
+    , tomos::mesh::Elements{
+          {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {0, 3, 4}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {0, 5, 6}}
+    }
+};
+
+const tomos::mesh::Mesh SQUARE = {
+    tomos::mesh::Nodes{
+          {{0.0, 0.0, 0.0}}
+        , {{1.0, 0.0, 0.0}}
+        , {{1.0, 1.0, 0.0}}
+        , {{0.0, 1.0, 0.0}}
+    }
+    , tomos::mesh::Elements{
+          {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 2}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {0, 2, 3}}
+    }
+};
+
+TEST(Native, Geometry) {
+    tomos::Native native(TRIANGLES);
+
+    std::vector<float> area                 = native.area();
+    std::vector<tomos::mesh::Node> centroid = native.centroid();
+    std::vector<tomos::mesh::Node> normal   = native.normal();
+
+    std::vector<float> areas = {0.5, 2.0, 4.5};
+    tomos::mesh::Nodes centroids = {
+          {{0.666666, 0.333333, 0.000000}}
+        , {{1.333333, 0.666666, 0.000000}}
+        , {{2.000000, 1.000000, 0.000000}}
+    };
+
+    ASSERT_EQ(area.size(), areas.size());
+    for (std::size_t i = 0; i < area.size(); i++) {
+        EXPECT_FLOAT_EQ(area[i], areas[i]);
+        EXPECT_FLOAT_EQ(normal[i].s[2], 2.0f * areas[i]);
+        for (std::size_t j = 0; j < 3; j++) {
+            EXPECT_NEAR(centroid[i].s[j], centroids[i].s[j], 1e-3);
+        }
+    }
+}
+
+TEST(Native, Square) {
+    tomos::Native native(SQUARE);
+    std::vector<float> expected = {
+           1.0  // (1, 1) -  0
+        , -0.5  // (1, 2) -  1
+        ,  0.0  // (1, 3) -  2
+        , -0.5  // (1, 4) -  3
+        , -0.5  // (2, 1) -  4
+        ,  1.0  // (2, 2) -  5
+        , -0.5  // (2, 3) -  6
+        ,  0.0  // (3, 1) -  7
+        , -0.5  // (3, 2) -  8
+        ,  1.0  // (3, 3) -  9
+        , -0.5  // (3, 4) - 10
+        , -0.5  // (4, 1) - 11
+        , -0.5  // (4, 3) - 12
+        ,  1.0  // (4, 4) - 13
+    };
+    std::vector<float> actual = native.color();
+    ASSERT_EQ(actual.size(), expected.size());
+
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], expected[i]);
+    }
+}
+
+TEST(Native, Conductivity) {
+    tomos::Native native(SQUARE, 1);
+    tomos::Native threaded(SQUARE, 4);
+
+    std::vector<float> homogeneous  = native.color();
+    std::vector<float> twos         = {2.0f, 2.0f};
+    std::vector<float> actual       = threaded.stiffness(twos);
+
+    ASSERT_EQ(actual.size(), homogeneous.size());
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        EXPECT_FLOAT_EQ(actual[i], 2.0f * homogeneous[i]);
+    }
+
+    std::vector<float> invalid = {1.0f};
+    EXPECT_THROW(native.stiffness(invalid), std::invalid_argument);
+
+    // thickness scales and a constant resistivity divides every entry
+    tomos::kernel::Options options;
+    options.thickness   = 0.5f;
+    options.resistivity = 4.0f;
+
+    std::vector<float> scaled = tomos::Native(SQUARE, 1, options).color();
+    for (std::size_t i = 0; i < scaled.size(); i++) {
+        EXPECT_FLOAT_EQ(scaled[i], homogeneous[i] / 8.0f);
+    }
+}
+
+TEST(Native, Symmetric) {
+    tomos::kernel::Options options;
+    options.symmetric = true;
+
+    auto topology = std::make_shared<tomos::Topology>(SQUARE);
+    tomos::Native full(topology, 2);
+    tomos::Native upper(topology, 2, options);
+
+    std::vector<float> fs = full.color();
+    std::vector<float> us = upper.color();
+
+    // (1, 1), (1, 2), (1, 3), (1, 4), (2, 2), (2, 3), (3, 3), (3, 4), (4, 4)
+    std::vector<float> expected = {1.0, -0.5, 0.0, -0.5, 1.0, -0.5, 1.0, -0.5, 1.0};
+    ASSERT_EQ(us.size(), expected.size());
+    for (std::size_t i = 0; i < us.size(); i++) { EXPECT_FLOAT_EQ(us[i], expected[i]); }
+
+    std::vector<float> x = {1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<float> y(4), z(4);
+    tomos::sparse::multiply(topology->pattern(), fs, x, y);
+    tomos::sparse::multiply(topology->pattern(tomos::sparse::Storage::UPPER), us, x, z);
+    for (std::size_t i = 0; i < x.size(); i++) { EXPECT_FLOAT_EQ(z[i], y[i]); }
+}
+
+TEST(Native, Partition) {
+    // 12 x 12 grid, split into one partition per thread
+    const std::size_t n = 12;
+    tomos::mesh::Mesh mesh;
+    for (std::size_t j = 0; j <= n; j++) {
+        for (std::size_t i = 0; i <= n; i++) {
+            mesh.nodes.push_back({{static_cast<float>(i), static_cast<float>(j), 0.0f, 0.0f}});
+        }
+    }
+    auto id = [&](std::size_t i, std::size_t j) { return static_cast<tomos::mesh::node::Number>(j * (n + 1) + i); };
+    for (std::size_t j = 0; j < n; j++) {
+        for (std::size_t i = 0; i < n; i++) {
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j), id(i + 1, j + 1)}});
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j + 1), id(i, j + 1)}});
+        }
+    }
+    std::vector<float> conductivity(mesh.elements.size());
+    for (std::size_t i = 0; i < conductivity.size(); i++) { conductivity[i] = 1.0f + static_cast<float>(i % 5); }
+
+    auto topology = std::make_shared<tomos::Topology>(mesh);
+    for (bool symmetric : {false, true}) {
+        tomos::kernel::Options options;
+        options.symmetric = symmetric;
+
+        tomos::Native native(topology, 4, options);
+        std::vector<float> expected = native.stiffness(conductivity);
+
+        native.strategy(tomos::Native::Strategy::PARTITION);
+        EXPECT_EQ(native.strategy(), tomos::Native::Strategy::PARTITION);
+        std::vector<float> actual = native.stiffness(conductivity);
+
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t i = 0; i < actual.size(); i++) {
+            EXPECT_NEAR(actual[i], expected[i], 1e-4f * std::max(1.0f, std::abs(expected[i])));
+        }
+
+        // same thread count, same summation order
+        EXPECT_EQ(native.stiffness(conductivity), actual);
+        tomos::Native again(topology, 4, options);
+        again.strategy(tomos::Native::Strategy::PARTITION);
+        EXPECT_EQ(again.stiffness(conductivity), actual);
+    }
+
+    tomos::Native single(SQUARE, 1);
+    single.strategy(tomos::Native::Strategy::PARTITION);
+    EXPECT_EQ(single.color(), tomos::Native(SQUARE, 1).color());
+}
+
+int
+main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -26,6 +26,25 @@ const tomos::mesh::Mesh MESH = {
     }
 };
 
+// n x n square grid of 2 n^2 triangles
+tomos::mesh::Mesh
+grid(std::size_t n) {
+    tomos::mesh::Mesh mesh;
+    for (std::size_t j = 0; j <= n; j++) {
+        for (std::size_t i = 0; i <= n; i++) {
+            mesh.nodes.push_back({{static_cast<float>(i), static_cast<float>(j), 0.0f, 0.0f}});
+        }
+    }
+    auto id = [&](std::size_t i, std::size_t j) { return static_cast<tomos::mesh::node::Number>(j * (n + 1) + i); };
+    for (std::size_t j = 0; j < n; j++) {
+        for (std::size_t i = 0; i < n; i++) {
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j), id(i + 1, j + 1)}});
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j + 1), id(i, j + 1)}});
+        }
+    }
+    return mesh;
+}
+
 TEST(Partition, Valid) {
     tomos::metis::Dual dual(MESH, tomos::metis::Common::EDGE);
     tomos::metis::Partitions ps = dual.partition(2);
@@ -34,6 +53,149 @@ TEST(Partition, Valid) {
     EXPECT_TRUE(tomos::partition::valid(MESH, ps, 6));
 }
 
+TEST(Partition, Statistics) {
+    // bottom and top row of the square, sharing the middle row of nodes
+    tomos::partition::Layout layout = tomos::partition::layout({0, 0, 0, 0, 1, 1, 1, 1}, 3);
+
+    tomos::partition::Statistics serial = tomos::partition::statistics(MESH, layout, 1);
+    EXPECT_EQ(serial.nodes, std::vector<std::size_t>({6, 6, 0}));
+    EXPECT_EQ(serial.halo, std::vector<std::size_t>({3, 3, 0}));
+    EXPECT_EQ(serial.maximum, 6);
+
+    tomos::partition::Statistics threaded = tomos::partition::statistics(MESH, layout, 4);
+    EXPECT_EQ(threaded.nodes, serial.nodes);
+    EXPECT_EQ(threaded.halo, serial.halo);
+
+    // a shared pool is reused across calls
+    tomos::parallel::Pool pool(2);
+    for (int i = 0; i < 2; i++) {
+        tomos::partition::Statistics pooled = tomos::partition::statistics(MESH, layout, pool);
+        EXPECT_EQ(pooled.nodes, serial.nodes);
+        EXPECT_EQ(pooled.halo, serial.halo);
+    }
+
+    tomos::partition::Statistics whole = tomos::partition::statistics(MESH, tomos::partition::layout({0, 0, 0, 0, 0, 0, 0, 0}, 1));
+    EXPECT_EQ(whole.nodes, std::vector<std::size_t>({MESH.nodes.size()}));
+    EXPECT_EQ(whole.halo, std::vector<std::size_t>({0}));
+}
+
+TEST(Partition, Submesh) {
+    tomos::partition::Layout layout = tomos::partition::layout({0, 0, 0, 0, 1, 1, 1, 1}, 2);
+    std::vector<tomos::partition::Submesh> submeshes = tomos::partition::submeshes(MESH, layout);
+    ASSERT_EQ(submeshes.size(), 2);
+
+    const tomos::partition::Submesh& bottom = submeshes[0];
+    EXPECT_EQ(bottom.elements, tomos::partition::Indices({0, 1, 2, 3}));
+    EXPECT_EQ(bottom.nodes, std::vector<tomos::mesh::node::Number>({0, 1, 2, 4, 3, 5}));
+    EXPECT_EQ(bottom.interior, 3);
+    EXPECT_EQ(bottom.halo(), 3);
+    EXPECT_EQ(bottom.connectivity, std::vector<tomos::partition::Local>({0, 3, 4, 0, 1, 3, 1, 2, 3, 2, 5, 3}));
+    EXPECT_EQ(bottom.offsets, std::vector<std::size_t>({0, 3, 6, 9, 12}));
+
+    // local numbers map back to the original elements
+    for (const tomos::partition::Submesh& submesh : submeshes) {
+        for (std::size_t i = 0; i < submesh.elements.size(); i++) {
+            const tomos::mesh::Element& element = MESH.elements[submesh.elements[i]];
+            for (std::size_t j = 0; j < element.nodes.size(); j++) {
+                EXPECT_EQ(submesh.nodes[submesh.connectivity[submesh.offsets[i] + j]], element.nodes[j]);
+            }
+        }
+    }
+    EXPECT_EQ(submeshes[1].nodes, std::vector<tomos::mesh::node::Number>({6, 7, 8, 3, 4, 5}));
+
+    tomos::parallel::Pool pool(2);
+    std::vector<tomos::partition::Submesh> pooled = tomos::partition::submeshes(MESH, layout, pool);
+    ASSERT_EQ(pooled.size(), 2);
+    EXPECT_EQ(pooled[0].nodes, bottom.nodes);
+    EXPECT_EQ(pooled[1].connectivity, submeshes[1].connectivity);
+}
+
+TEST(Partition, Layout) {
+    tomos::partition::Layout layout = tomos::partition::layout({1, 0, 2, 1, 0, 1}, 4);
+
+    EXPECT_EQ(layout.offsets, std::vector<std::size_t>({0, 2, 5, 6, 6}));
+    EXPECT_EQ(layout.elements, tomos::partition::Indices({1, 4, 0, 3, 5, 2}));
+
+    tomos::partition::Partitions ps = layout.partitions();
+    ASSERT_EQ(ps.size(), 3);
+    EXPECT_EQ(ps[1], tomos::partition::Indices({0, 3, 5}));
+
+    // two thirds of the weight on a partition targeted at one half
+    EXPECT_FLOAT_EQ(tomos::partition::imbalance(tomos::partition::layout({0, 0, 1}, 2), {}, {}), 4.0f / 3.0f);
+    EXPECT_FLOAT_EQ(tomos::partition::imbalance(tomos::partition::layout({0, 0, 1}, 2), {}, {2.0f, 1.0f}), 1.0f);
+    EXPECT_FLOAT_EQ(tomos::partition::imbalance(tomos::partition::layout({0, 0, 1}, 2), {1, 1, 2}, {}), 1.0f);
+
+    EXPECT_THROW(tomos::partition::layout({0, 2}, 2), std::out_of_range);
+}
+
+TEST(Partition, Weighted) {
+    tomos::metis::Dual dual(MESH, tomos::metis::Common::EDGE);
+
+    tomos::partition::Options options;
+    options.count   = 1;
+    options.compute = {1, 2, 1, 2, 1, 2, 1, 2};
+
+    tomos::partition::Layout single = dual.partition(options);
+    EXPECT_EQ(single.edgecut, 0);
+    EXPECT_EQ(single.imbalance, std::vector<float>({1.0f}));
+    EXPECT_EQ(single.offsets, std::vector<std::size_t>({0, 8}));
+
+    options.count   = 2;
+    options.nodes   = std::vector<std::size_t>(8, 3);
+    options.targets = {3.0f, 1.0f};
+
+    tomos::partition::Layout layout = dual.partition(options);
+    ASSERT_EQ(layout.part.size(), MESH.elements.size());
+    ASSERT_EQ(layout.offsets.size(), 3);
+    ASSERT_EQ(layout.imbalance.size(), 2);
+    EXPECT_EQ(layout.offsets.back(), MESH.elements.size());
+    for (std::size_t p = 0; p < 2; p++) {
+        for (std::size_t i = layout.offsets[p]; i < layout.offsets[p + 1]; i++) {
+            EXPECT_EQ(layout.part[layout.elements[i]], p);
+        }
+    }
+    EXPECT_GE(layout.imbalance[0], 1.0f);
+
+    options.targets = {1.0f};
+    EXPECT_THROW(dual.partition(options), std::invalid_argument);
+    options.targets = {};
+    options.compute = {1};
+    EXPECT_THROW(dual.partition(options), std::invalid_argument);
+}
+
+TEST(Partition, Optimal) {
+    tomos::mesh::Mesh mesh = grid(24);
+    tomos::metis::Dual dual(mesh, tomos::metis::Common::EDGE);
+    const std::size_t limit = 100;
+
+    // thread counts probe different counts and fitting is not monotone in
+    // the count, so each result is only checked on its own: at least
+    // nodes / limit partitions, and the result fits
+    for (std::size_t threads : {1, 4}) {
+        std::size_t count = tomos::partition::optimal(dual, mesh, limit, threads);
+        EXPECT_GE(count, (mesh.nodes.size() + limit - 1) / limit);
+        EXPECT_TRUE(tomos::partition::valid(mesh, dual.partition(count), limit));
+    }
+
+    EXPECT_EQ(tomos::partition::optimal(MESH, MESH.nodes.size()), 1);
+    EXPECT_THROW(tomos::partition::optimal(MESH, 2), std::domain_error);
+}
+
+TEST(Partition, Bisection) {
+    tomos::mesh::Mesh mesh = grid(24);
+    tomos::metis::Dual dual(mesh, tomos::metis::Common::EDGE);
+    const std::size_t limit = 100;
+
+    tomos::partition::Layout layout = tomos::partition::bisection(dual, mesh, limit);
+    ASSERT_EQ(layout.part.size(), mesh.elements.size());
+    EXPECT_EQ(layout.offsets.back(), mesh.elements.size());
+    EXPECT_TRUE(tomos::partition::valid(mesh, layout.partitions(), limit));
+    EXPECT_GE(layout.offsets.size() - 1, (mesh.nodes.size() + limit - 1) / limit);
+
+    tomos::partition::Layout whole = tomos::partition::bisection(dual, mesh, mesh.nodes.size());
+    EXPECT_EQ(whole.offsets, std::vector<std::size_t>({0, mesh.elements.size()}));
+}
+
 int
 main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,106 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <tomos/tomos.hpp>
+#include <tomos/tomos-mesh.hpp>
+
+// 4 x 4 square grid of 32 triangles with its nodes numbered in a scrambled order
+tomos::mesh::Mesh
+scrambled() {
+    const std::size_t side = 5;
+    std::vector<tomos::mesh::node::Number> number(side * side);
+    for (std::size_t i = 0; i < number.size(); i++) { number[i] = (7 * i) % number.size(); }
+
+    tomos::mesh::Mesh mesh;
+    mesh.nodes.resize(number.size());
+    for (std::size_t j = 0; j < side; j++) {
+        for (std::size_t i = 0; i < side; i++) {
+            mesh.nodes[number[j * side + i]] = {{static_cast<float>(i), static_cast<float>(j), 0.0f, 0.0f}};
+        }
+    }
+    auto id = [&](std::size_t i, std::size_t j) { return number[j * side + i]; };
+    for (std::size_t j = 0; j + 1 < side; j++) {
+        for (std::size_t i = 0; i + 1 < side; i++) {
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j), id(i + 1, j + 1)}});
+            mesh.elements.push_back({tomos::mesh::element::Type::TRIANGLE3, {id(i, j), id(i + 1, j + 1), id(i, j + 1)}});
+        }
+    }
+    return mesh;
+}
+
+void
+permutation(const tomos::reorder::Ordering& ordering, std::size_t count) {
+    ASSERT_EQ(ordering.order.size(), count);
+    ASSERT_EQ(ordering.rank.size(), count);
+    for (std::size_t i = 0; i < count; i++) { EXPECT_EQ(ordering.rank[ordering.order[i]], i); }
+}
+
+TEST(Reorder, Ordering) {
+    tomos::reorder::Ordering ordering = tomos::reorder::ordering({2, 0, 1});
+    EXPECT_EQ(ordering.rank, tomos::reorder::Permutation({1, 2, 0}));
+
+    std::vector<float> values   = {10.0f, 20.0f, 30.0f};
+    std::vector<float> permuted = tomos::reorder::permute<float>(ordering, values);
+    EXPECT_EQ(permuted, std::vector<float>({30.0f, 10.0f, 20.0f}));
+    EXPECT_EQ(tomos::reorder::restore<float>(ordering, permuted), values);
+
+    EXPECT_THROW(tomos::reorder::ordering({0, 0, 1}), std::invalid_argument);
+    EXPECT_THROW(tomos::reorder::ordering({0, 3, 1}), std::invalid_argument);
+}
+
+TEST(Reorder, RCM) {
+    tomos::mesh::Mesh mesh = scrambled();
+    tomos::reorder::Ordering nodes = tomos::reorder::rcm(tomos::metis::Nodal(mesh));
+    permutation(nodes, mesh.nodes.size());
+
+    tomos::reorder::Reordered reordered = tomos::reorder::apply(
+              mesh
+            , nodes
+            , tomos::reorder::identity(mesh.elements.size())
+            );
+    EXPECT_LT(tomos::reorder::bandwidth(reordered.mesh), tomos::reorder::bandwidth(mesh));
+    EXPECT_LE(tomos::reorder::bandwidth(reordered.mesh), 6);
+}
+
+TEST(Reorder, Curves) {
+    tomos::mesh::Mesh mesh = scrambled();
+
+    for (const auto& ordering : {tomos::reorder::morton(mesh), tomos::reorder::hilbert(mesh)}) {
+        permutation(ordering, mesh.elements.size());
+    }
+
+    // consecutive elements along the Hilbert curve are never far apart
+    tomos::reorder::Ordering elements = tomos::reorder::hilbert(mesh);
+    std::vector<tomos::mesh::Node> centroids = tomos::Native(mesh, 1).centroid();
+    for (std::size_t i = 0; i + 1 < elements.order.size(); i++) {
+        const tomos::mesh::Node& a = centroids[elements.order[i]];
+        const tomos::mesh::Node& b = centroids[elements.order[i + 1]];
+        EXPECT_LT(std::hypot(a.s[0] - b.s[0], a.s[1] - b.s[1]), 1.5f);
+    }
+}
+
+TEST(Reorder, Restore) {
+    tomos::mesh::Mesh mesh = scrambled();
+
+    for (tomos::reorder::Elements elements : {tomos::reorder::Elements::MORTON, tomos::reorder::Elements::PARTITION}) {
+        tomos::reorder::Options options;
+        options.elements = elements;
+        options.parts    = 2;
+
+        tomos::reorder::Reordered reordered = tomos::reorder::build(mesh, options);
+        permutation(reordered.nodes, mesh.nodes.size());
+        permutation(reordered.elements, mesh.elements.size());
+
+        std::vector<float> expected = tomos::Native(mesh, 1).area();
+        std::vector<float> areas    = tomos::Native(reordered.mesh, 1).area();
+        std::vector<float> actual   = tomos::reorder::restore<float>(reordered.elements, areas);
+
+        ASSERT_EQ(actual.size(), expected.size());
+        for (std::size_t i = 0; i < actual.size(); i++) { EXPECT_FLOAT_EQ(actual[i], expected[i]); }
+    }
+}
+
+int
+main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
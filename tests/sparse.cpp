@@ -61,6 +61,170 @@ TEST(Sparse, CSR) {
     }
 }
 
+TEST(Sparse, Pattern) {
+    std::vector<std::uint32_t> cols = {
+          0, 1, 3, 4
+        , 0, 1, 2, 4
+        , 1, 2, 4, 5
+        , 0, 3, 4, 6
+        , 0, 1, 2, 3, 4, 5, 6, 7, 8
+        , 2, 4, 5, 8
+        , 3, 4, 6, 7
+        , 4, 6, 7, 8
+        , 4, 5, 7, 8
+    };
+    std::vector<std::uint32_t> rows = {0, 4, 8, 12, 16, 25, 29, 33, 37, 41};
+    tomos::metis::Nodal nodal(MESH);
+
+    ASSERT_EQ(tomos::sparse::nonzeros(nodal), cols.size());
+
+    const auto pattern = tomos::sparse::pattern<std::uint32_t>(nodal);
+    EXPECT_EQ(pattern.rows, rows);
+    EXPECT_EQ(pattern.cols, cols);
+
+    // preallocated buffers, wrong sizes are rejected
+    std::vector<std::uint64_t> rs(rows.size());
+    std::vector<std::uint64_t> cs(cols.size());
+    tomos::sparse::csr<std::uint64_t>(nodal, rs, cs);
+    for (std::size_t i = 0; i < rows.size(); i++) { EXPECT_EQ(rs[i], rows[i]); }
+    for (std::size_t i = 0; i < cols.size(); i++) { EXPECT_EQ(cs[i], cols[i]); }
+
+    cs.pop_back();
+    EXPECT_THROW(tomos::sparse::csr<std::uint64_t>(nodal, rs, cs), std::length_error);
+}
+
+TEST(Sparse, Scatter) {
+    tomos::metis::Nodal nodal(MESH);
+    const auto pattern              = tomos::sparse::pattern<std::uint32_t>(nodal);
+    tomos::parallel::Pool pool(4);
+    std::vector<std::uint32_t> slots = tomos::sparse::scatter(MESH, pattern, pool);
+
+    ASSERT_EQ(slots.size(), 9 * MESH.elements.size());
+    for (std::size_t e = 0; e < MESH.elements.size(); e++) {
+        const auto& nodes = MESH.elements[e].nodes;
+        for (std::size_t i = 0; i < 3; i++) {
+        for (std::size_t j = 0; j < 3; j++) {
+            std::uint32_t slot = slots[9 * e + 3 * i + j];
+            EXPECT_GE(slot, pattern.rows[nodes[i]]);
+            EXPECT_LT(slot, pattern.rows[nodes[i] + 1]);
+            EXPECT_EQ(pattern.cols[slot], nodes[j]);
+        }
+        }
+    }
+
+    // coo follows the same layout
+    for (const auto& [coordinate, slot] : tomos::sparse::coo(nodal)) {
+        EXPECT_EQ(pattern.cols[slot], coordinate.second);
+    }
+}
+
+TEST(Sparse, Upper) {
+    std::vector<std::uint32_t> cols = {
+          0, 1, 3, 4
+        , 1, 2, 4
+        , 2, 4, 5
+        , 3, 4, 6
+        , 4, 5, 6, 7, 8
+        , 5, 8
+        , 6, 7
+        , 7, 8
+        , 8
+    };
+    std::vector<std::uint32_t> rows = {0, 4, 7, 10, 13, 18, 20, 22, 24, 25};
+    tomos::metis::Nodal nodal(MESH);
+
+    const auto upper = tomos::sparse::pattern<std::uint32_t>(nodal, tomos::sparse::Storage::UPPER);
+    EXPECT_EQ(upper.rows, rows);
+    EXPECT_EQ(upper.cols, cols);
+    EXPECT_EQ(tomos::sparse::nonzeros(nodal, tomos::sparse::Storage::UPPER), cols.size());
+
+    // six slots per triangle, every one in the row of the smaller node
+    std::vector<std::uint32_t> slots = tomos::sparse::scatter(MESH, upper);
+    ASSERT_EQ(slots.size(), 6 * MESH.elements.size());
+    for (std::size_t e = 0; e < MESH.elements.size(); e++) {
+        const auto& nodes   = MESH.elements[e].nodes;
+        std::size_t k       = 6 * e;
+        for (std::size_t i = 0; i < 3; i++) {
+        for (std::size_t j = i; j < 3; j++) {
+            std::uint32_t row = std::min(nodes[i], nodes[j]);
+            std::uint32_t col = std::max(nodes[i], nodes[j]);
+            EXPECT_GE(slots[k], upper.rows[row]);
+            EXPECT_LT(slots[k], upper.rows[row + 1]);
+            EXPECT_EQ(upper.cols[slots[k]], col);
+            k++;
+        }
+        }
+    }
+}
+
+TEST(Sparse, Multiply) {
+    tomos::metis::Nodal nodal(MESH);
+    const auto full     = tomos::sparse::pattern<std::uint32_t>(nodal);
+    const auto upper    = tomos::sparse::pattern<std::uint32_t>(nodal, tomos::sparse::Storage::UPPER);
+
+    // a_ij = i + j + 1 is symmetric
+    std::vector<float> fs, us;
+    for (std::size_t row = 0; row < MESH.nodes.size(); row++) {
+        for (std::uint32_t k = full.rows[row]; k < full.rows[row + 1]; k++) { fs.push_back(row + full.cols[k] + 1.0f); }
+        for (std::uint32_t k = upper.rows[row]; k < upper.rows[row + 1]; k++) { us.push_back(row + upper.cols[k] + 1.0f); }
+    }
+
+    std::vector<float> x(MESH.nodes.size());
+    for (std::size_t i = 0; i < x.size(); i++) { x[i] = 0.5f * i - 1.0f; }
+
+    std::vector<float> expected(x.size()), actual(x.size());
+    tomos::sparse::multiply(full, fs, x, expected);
+    tomos::sparse::multiply(upper, us, x, actual);
+    for (std::size_t i = 0; i < x.size(); i++) { EXPECT_FLOAT_EQ(actual[i], expected[i]); }
+
+    x.pop_back();
+    EXPECT_THROW(tomos::sparse::multiply(full, fs, x, expected), std::length_error);
+}
+
+TEST(Sparse, Sell) {
+    tomos::metis::Nodal nodal(MESH);
+    const auto full = tomos::sparse::pattern<std::uint32_t>(nodal);
+
+    std::vector<float> values(full.cols.size());
+    for (std::size_t k = 0; k < values.size(); k++) { values[k] = 1.0f + 0.25f * k; }
+    std::vector<float> x(MESH.nodes.size());
+    for (std::size_t i = 0; i < x.size(); i++) { x[i] = 0.5f * i - 1.0f; }
+
+    std::vector<float> expected(x.size());
+    tomos::sparse::multiply(full, values, x, expected);
+
+    for (std::size_t chunk : {1, 2, 4, 32}) {
+        tomos::sparse::Sell<std::uint32_t> sell = tomos::sparse::sell(full, chunk, 4);
+        EXPECT_EQ(sell.slices.back(), sell.cols.size());
+        EXPECT_GE(sell.fill(), 1.0);
+
+        std::vector<float> packed = tomos::sparse::pack(sell, values);
+        ASSERT_EQ(packed.size(), sell.cols.size());
+
+        std::vector<float> actual(x.size());
+        tomos::sparse::multiply(sell, packed, x, actual);
+        for (std::size_t i = 0; i < x.size(); i++) { EXPECT_FLOAT_EQ(actual[i], expected[i]); }
+    }
+
+    // a single-row slice stores no padding
+    EXPECT_DOUBLE_EQ(tomos::sparse::sell(full, 1, 1).fill(), 1.0);
+    EXPECT_THROW(tomos::sparse::sell(tomos::sparse::pattern<std::uint32_t>(nodal, tomos::sparse::Storage::UPPER)), std::invalid_argument);
+}
+
+TEST(Sparse, Format) {
+    tomos::metis::Nodal nodal(MESH);
+    tomos::sparse::Lengths lengths = tomos::sparse::lengths(tomos::sparse::pattern<std::uint32_t>(nodal));
+
+    // the centre node couples to all 9 nodes, the corners to 4
+    EXPECT_EQ(lengths.maximum, 9);
+    EXPECT_GT(lengths.mean, 3.0);
+    EXPECT_GT(lengths.deviation, 0.0);
+
+    EXPECT_EQ(tomos::sparse::select(lengths, 1.2), tomos::sparse::Format::SELL);
+    EXPECT_EQ(tomos::sparse::select(lengths, 3.0), tomos::sparse::Format::SCALAR);
+    EXPECT_EQ(tomos::sparse::select({64.0, 0.0, 64}, 3.0), tomos::sparse::Format::VECTOR);
+}
+
 int
 main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
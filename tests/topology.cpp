@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <tomos/tomos.hpp>
+#include <tomos/tomos-mesh.hpp>
+
+const tomos::mesh::Mesh MESH = {
+    tomos::mesh::Nodes{
+          {{0.0f, 0.0f, 0.0f}}
+        , {{1.0f, 0.0f, 0.0f}}
+        , {{2.0f, 0.0f, 0.0f}}
+        , {{0.0f, 1.0f, 0.0f}}
+        , {{1.0f, 1.0f, 0.0f}}
+        , {{2.0f, 1.0f, 0.0f}}
+        , {{0.0f, 2.0f, 0.0f}}
+        , {{1.0f, 2.0f, 0.0f}}
+        , {{2.0f, 2.0f, 0.0f}}
+    }
+    , tomos::mesh::Elements{
+          {tomos::mesh::element::Type::TRIANGLE3, {0, 4, 3}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {0, 1, 4}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {1, 2, 4}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {2, 5, 4}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {3, 4, 6}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {6, 4, 7}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {4, 8, 7}}
+        , {tomos::mesh::element::Type::TRIANGLE3, {4, 5, 8}}
+    }
+};
+
+TEST(Topology, Cached) {
+    tomos::Topology topology(MESH);
+
+    EXPECT_EQ(&topology.nodal(), &topology.nodal());
+    EXPECT_EQ(&topology.dual(tomos::metis::Common::NODE), &topology.dual(tomos::metis::Common::NODE));
+    EXPECT_NE(&topology.dual(tomos::metis::Common::NODE), &topology.dual(tomos::metis::Common::EDGE));
+    EXPECT_EQ(&topology.pattern(), &topology.pattern());
+    EXPECT_EQ(&topology.colors(tomos::metis::Common::NODE), &topology.colors(tomos::metis::Common::NODE));
+    EXPECT_EQ(&topology.partitions(2), &topology.partitions(2));
+}
+
+TEST(Topology, Consistent) {
+    tomos::Topology topology(MESH);
+
+    const auto& pattern = topology.pattern();
+    EXPECT_EQ(pattern.cols.size(), tomos::sparse::nonzeros(topology.nodal()));
+    EXPECT_EQ(pattern.rows.size(), MESH.nodes.size() + 1);
+    EXPECT_EQ(topology.scatter().size(), 9 * MESH.elements.size());
+
+    EXPECT_EQ(topology.colors(tomos::metis::Common::NODE), tomos::color::build(MESH, tomos::metis::Common::NODE));
+    EXPECT_EQ(topology.optimal(6), tomos::partition::optimal(MESH, 6));
+}
+
+TEST(Topology, Native) {
+    auto topology = std::make_shared<tomos::Topology>(MESH);
+    tomos::Native shared(topology, 2);
+    tomos::Native owned(MESH, 2);
+
+    std::vector<float> expected = owned.color();
+    std::vector<float> actual   = shared.color();
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); i++) { EXPECT_FLOAT_EQ(actual[i], expected[i]); }
+}
+
+int
+main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}